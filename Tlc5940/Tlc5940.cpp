@@ -22,6 +22,7 @@
 /* For AVR */
 #if defined(__AVR__)
     #include <avr/io.h>
+    #include <avr/interrupt.h>
 #endif
 
 /* For PIC32 */
@@ -30,8 +31,6 @@
     #include <plib.h>       /* this gives the i/o definitions */
 #endif
 
-//#include <avr/interrupt.h>
-
 #include "tlc_config.h"
 #include "Tlc5940.h"
 
@@ -42,10 +41,41 @@
     been latched in yet. */
 volatile uint8_t tlc_needXLAT;
 
+#if TLC_DIRTY_TRACKING
+
+/** This will be true (!= 0) if #tlc_GSData has changed since it was last
+    shifted out.  Animation code can check this to see if a frame is needed. */
+volatile uint8_t tlc_GSDirty;
+
+/** The number of Tlc.update() (or Tlc.commit()) calls that didn't shift
+    anything because #tlc_GSDirty was clear. */
+volatile uint32_t tlc_skippedUpdates;
+
+#endif
+
 /** Some of the extened library will need to be called after a successful
     update. */
 volatile void (*tlc_onUpdateFinished)(void);
 
+/** Set while the XLAT interrupt runs #tlc_onUpdateFinished.  The callback
+    runs with interrupts on, so the next XLAT interrupt can come before it
+    returns; that one doesn't call it again (see TIMER1_OVF_vect). */
+static volatile uint8_t tlc_inUpdateFinished;
+
+#if TLC_PWM_TICKS
+
+/** This will be true (!= 0) if the Timer1 overflow interrupt has to handle
+    an XLAT pulse (set_XLAT_interrupt()), not only count the period. */
+volatile uint8_t tlc_XLATArmed;
+
+/** The number of PWM periods since Tlc.init(), incremented by the Timer1
+    overflow interrupt.  Wraps after 2^32 periods (about 50 days with the
+    default TLC_PWM_PERIOD).  Read it with tlc_getPwmTicks() outside of
+    interrupts. */
+volatile uint32_t tlc_pwmTicks;
+
+#endif
+
 /** Packed grayscale data, 24 bytes (16 * 12 bits) per TLC.
 
     Format: Lets assume we have 2 TLCs, A and B, daisy-chained with the SOUT of
@@ -61,25 +91,121 @@ volatile void (*tlc_onUpdateFinished)(void);
 
     \note Normally packing data like this is bad practice.  But in this
           situation, shifting the data out is really fast because the format of
-          the array is the same as the format of the TLC's serial interface. */
+          the array is the same as the format of the TLC's serial interface.
+    With #TLC_PARALLEL_BITBANG each chain's TLCs are a block of
+    TLC_CHAIN_TLCS * 24 bytes in the same format, the last chain's block
+    first.
+
+    \note With #TLC_DOUBLE_BUFFER this points to the back buffer. */
+#if TLC_DOUBLE_BUFFER
+
+/** Storage for the front and back grayscale buffers. */
+static uint8_t tlc_GSBuffers[2][NUM_TLCS * 24];
+uint8_t *tlc_GSData = tlc_GSBuffers[0];
+
+/** The grayscale buffer that Tlc.update() shifts out.  Only Tlc.commit()
+    changes this (it swaps it with #tlc_GSData). */
+uint8_t *tlc_GSFront = tlc_GSBuffers[1];
+
+/** This will be true (!= 0) if a frame was committed while the previous one
+    was waiting to be latched.  The XLAT interrupt shifts it in. */
+static volatile uint8_t tlc_GSPending;
+
+#else
 uint8_t tlc_GSData[NUM_TLCS * 24];
+#endif
 
 /** Don't add an extra SCLK pulse after switching from dot-correction mode. */
 static uint8_t firstGSInput;
 
-/** Interrupt called after an XLAT pulse to prevent more XLAT pulses. */
-/*
+#if TLC_ASYNC_UPDATE
+/** The next byte of #tlc_GSData to be shifted out by the SPI interrupt. */
+static uint8_t *tlc_transferp;
+#endif
+
+#if defined(__AVR__) || defined(TLC_HOST)
+
+/** Interrupt called after an XLAT pulse to prevent more XLAT pulses.  With
+    #TLC_PWM_TICKS it's called every PWM period.
+
+    #tlc_onUpdateFinished is called with interrupts on and is never
+    re-entered: if it takes longer than a PWM period (a full fade pool or
+    many tracks on a slow clock) and the update it started latches before
+    it returns, the nested interrupt only re-arms itself, and the callback
+    runs again one PWM period later.  So a callback step can take any time,
+    it's skipped (not stacked) for every period it overruns. */
 ISR(TIMER1_OVF_vect)
 {
+#if TLC_PWM_TICKS
+    tlc_pwmTicks++;
+    if (!tlc_XLATArmed) {
+        return;
+    }
+#endif
     disable_XLAT_pulses();
     clear_XLAT_interrupt();
     tlc_needXLAT = 0;
+#if TLC_DOUBLE_BUFFER
+    if (tlc_GSPending) {
+        tlc_GSPending = 0;
+        sei();
+        Tlc.update();
+    }
+#endif
     if (tlc_onUpdateFinished) {
+        if (tlc_inUpdateFinished) {
+            if (!tlc_needXLAT) { // (an update sets the XLAT interrupt itself)
+                set_XLAT_interrupt();
+            }
+            return;
+        }
+        tlc_inUpdateFinished = 1;
         sei();
         tlc_onUpdateFinished();
+        tlc_inUpdateFinished = 0;
     }
 }
-*/
+
+#if TLC_ASYNC_UPDATE
+
+/** Loads the next byte of an update, or enables the XLAT pulse once the last
+    byte is out.  Run by the SPI interrupt, and by Tlc.commit() with
+    interrupts off. */
+static inline void tlc_transferNext(void)
+{
+    if (tlc_transferp < tlc_GSFront + NUM_TLCS * 24) {
+        SPDR = *tlc_transferp++;
+    } else {
+        SPCR &= ~_BV(SPIE);
+        enable_XLAT_pulses();
+        set_XLAT_interrupt();
+    }
+}
+
+/** Interrupt called after each byte of an update has been shifted out. */
+ISR(SPI_STC_vect)
+{
+    tlc_transferNext();
+}
+
+#endif
+
+#endif
+
+#if TLC_DOUBLE_BUFFER
+
+/** Copies a whole grayscale buffer (NUM_TLCS * 24 bytes). */
+static void tlc_copyGSBuffer(uint8_t *dest, uint8_t *src)
+{
+    uint8_t *end = dest + NUM_TLCS * 24;
+    while (dest < end) {
+        *dest++ = *src++;
+        *dest++ = *src++;
+        *dest++ = *src++;
+    }
+}
+
+#endif
 
 /** \defgroup ReqVPRG_ENABLED Functions that Require VPRG_ENABLED
     Functions that require VPRG_ENABLED == 1.
@@ -120,7 +246,14 @@ void Tlc5940::init(uint16_t initialValue)
     tlc_shift8_init();
 
     setAll(initialValue);
+#if TLC_DOUBLE_BUFFER
+    tlc_copyGSBuffer(tlc_GSFront, tlc_GSData);
+#if TLC_DIRTY_TRACKING
+    tlc_GSDirty = 0; // the front buffer has the same data
+#endif
+#endif
     update();
+    tlc_waitForTransfer();
     disable_XLAT_pulses();
     clear_XLAT_interrupt();
     tlc_needXLAT = 0;
@@ -160,8 +293,19 @@ void Tlc5940::init(uint16_t initialValue)
     OCR2B = 0;                // duty factor (as short a pulse as possible)
     OCR2A = TLC_GSCLK_PERIOD; // see tlc_config.h
     TCCR2B |= _BV(CS20);      // no prescale, (start pwm output)
+#endif
+#if TLC_PWM_TICKS
+#if defined(TLC_ATMEGA_8_H)
+    TIMSK |= _BV(TOIE1);      // count every period, see tlc_pwmTicks
+#else
+    TIMSK1 = _BV(TOIE1);      // count every period, see tlc_pwmTicks
+#endif
 #endif
     TCCR1B |= _BV(CS10);      // no prescale, (start pwm output)
+#if !TLC_DOUBLE_BUFFER
+    tlc_markGSDirty(); // the first update() cleared it, this one sends the
+                       // extra SCLK pulse after the manual XLAT
+#endif
     update();
 }
 
@@ -180,13 +324,25 @@ void Tlc5940::clear(void)
     \code while(Tlc.update()); \endcode
     or
     \code while(tlc_needXLAT); \endcode
+    If #TLC_ASYNC_UPDATE is enabled this only loads the first byte; the SPI
+    interrupt shifts out the rest while the sketch keeps running.
+    If #TLC_DIRTY_TRACKING is enabled and nothing has changed since the last
+    update, nothing is shifted in.
     \returns 1 if there is data waiting to be latched, 0 if data was
-             successfully shifted in */
+             successfully shifted in (or the transfer was started, or there
+             was nothing to shift) */
 uint8_t Tlc5940::update(void)
 {
     if (tlc_needXLAT) {
         return 1;
     }
+#if TLC_DIRTY_TRACKING && !TLC_DOUBLE_BUFFER
+    if (!tlc_GSDirty) {
+        tlc_skippedUpdates++;
+        return 0;
+    }
+    tlc_GSDirty = 0;
+#endif
     disable_XLAT_pulses();
     if (firstGSInput) {
         // adds an extra SCLK pulse unless we've just set dot-correction data
@@ -194,18 +350,112 @@ uint8_t Tlc5940::update(void)
     } else {
         pulse_pin(SCLK_PORT, SCLK_PIN);
     }
-    uint8_t *p = tlc_GSData;
-    while (p < tlc_GSData + NUM_TLCS * 24) {
+    tlc_needXLAT = 1;
+#if TLC_ASYNC_UPDATE
+    tlc_transferp = tlc_GSFront + 1;
+    SPDR = *tlc_GSFront; // starts transmission, the SPI interrupt does the rest
+    SPCR |= _BV(SPIE);
+#elif DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+    uint8_t bytes[TLC_NUM_CHAINS];
+    uint8_t *p = tlc_GSFront; // the data of the last chain comes first
+    while (p < tlc_GSFront + TLC_CHAIN_TLCS * 24) {
+        uint8_t *chainp = p++;
+        uint8_t *bytep = bytes + TLC_NUM_CHAINS;
+        while (bytep > bytes) {
+            *--bytep = *chainp;
+            chainp += TLC_CHAIN_TLCS * 24;
+        }
+        tlc_shift8Chains(bytes);
+    }
+    enable_XLAT_pulses();
+    set_XLAT_interrupt();
+#elif DATA_TRANSFER_MODE == TLC_USART_SPI
+    uint8_t *p = tlc_GSFront;
+    while (p < tlc_GSFront + NUM_TLCS * 24) {
+        while (!(TLC_UCSRA & _BV(TLC_UDRE)))
+            ; // wait for room in the transmit buffer
+        TLC_UDR = *p++;
+    }
+    TLC_UCSRA = _BV(TLC_TXC); // clears TXC
+    tlc_shift8_wait(); // XLAT can't happen until the last byte is out
+    enable_XLAT_pulses();
+    set_XLAT_interrupt();
+#elif DATA_TRANSFER_MODE == TLC_SPI
+    uint8_t *p = tlc_GSFront;
+    SPDR = *p++; // starts transmission
+    tlc_spiNext8(*p++);
+    tlc_spiNext8(*p++);
+    while (p < tlc_GSFront + NUM_TLCS * 24) {
+        tlc_spiNext8(*p++);
+        tlc_spiNext8(*p++);
+        tlc_spiNext8(*p++);
+    }
+    tlc_spiWait();
+    enable_XLAT_pulses();
+    set_XLAT_interrupt();
+#else
+    uint8_t *p = tlc_GSFront;
+    while (p < tlc_GSFront + NUM_TLCS * 24) {
         tlc_shift8(*p++);
         tlc_shift8(*p++);
         tlc_shift8(*p++);
     }
-    tlc_needXLAT = 1;
     enable_XLAT_pulses();
     set_XLAT_interrupt();
+#endif
     return 0;
 }
 
+#if TLC_DOUBLE_BUFFER
+
+/** Makes the back buffer, #tlc_GSData, the next frame to be displayed.  The
+    frame is shifted in right away, or by the XLAT interrupt if the previous
+    frame hasn't been latched yet (a newer commit replaces a frame that is
+    still waiting).  Never waits for an XLAT, so call this instead of
+    update().  The back buffer keeps the committed values.
+
+    With #TLC_ASYNC_UPDATE the buffers can't be swapped while the SPI
+    interrupt is still shifting out the front one, so this shifts out the
+    rest of it itself (at most #NUM_TLCS * 24 bytes), a byte at a time with
+    interrupts off.  It works with interrupts off too (from an interrupt or
+    inside cli()), where the SPI interrupt can't run. */
+void Tlc5940::commit(void)
+{
+#if TLC_DIRTY_TRACKING
+    if (!tlc_GSDirty) {
+        tlc_skippedUpdates++;
+        return;
+    }
+    tlc_GSDirty = 0;
+#endif
+    uint8_t oldSREG = SREG;
+    cli();
+#if TLC_ASYNC_UPDATE
+    while (SPCR & _BV(SPIE)) { // the front buffer is still being shifted out
+        SREG = oldSREG; // (the SPI interrupt may load the next byte)
+        cli();
+        if (SPSR & _BV(SPIF)) {
+            (void)SPDR; // clears SPIF, like running the interrupt
+            tlc_transferNext();
+        }
+    }
+#endif
+    uint8_t *front = tlc_GSData;
+    tlc_GSData = tlc_GSFront;
+    tlc_GSFront = front;
+    uint8_t needUpdate = !tlc_needXLAT;
+    if (!needUpdate) {
+        tlc_GSPending = 1;
+    }
+    SREG = oldSREG;
+    tlc_copyGSBuffer(tlc_GSData, front);
+    if (needUpdate) {
+        update();
+    }
+}
+
+#endif
+
 /** Sets channel to value in the grayscale data array, #tlc_GSData.
     \param channel (0 to #NUM_TLCS * 16 - 1).  OUT0 of the first TLC is
            channel 0, OUT0 of the next TLC is channel 16, etc.
@@ -214,17 +464,8 @@ uint8_t Tlc5940::update(void)
 void Tlc5940::set(TLC_CHANNEL_TYPE channel, uint16_t value)
 {
     TLC_CHANNEL_TYPE index8 = (NUM_TLCS * 16 - 1) - channel;
-    uint8_t *index12p = tlc_GSData + ((((uint16_t)index8) * 3) >> 1);
-    if (index8 & 1) { // starts in the middle
-                      // first 4 bits intact | 4 top bits of value
-        *index12p = (*index12p & 0xF0) | (value >> 8);
-                      // 8 lower bits of value
-        *(++index12p) = value & 0xFF;
-    } else { // starts clean
-                      // 8 upper bits of value
-        *(index12p++) = value >> 4;
-                      // 4 lower bits of value | last 4 bits intact
-        *index12p = ((uint8_t)(value << 4)) | (*index12p & 0xF);
+    if (tlc_setPacked(tlc_GSData, index8, value)) {
+        tlc_markGSDirty();
     }
 }
 
@@ -236,27 +477,51 @@ void Tlc5940::set(TLC_CHANNEL_TYPE channel, uint16_t value)
 uint16_t Tlc5940::get(TLC_CHANNEL_TYPE channel)
 {
     TLC_CHANNEL_TYPE index8 = (NUM_TLCS * 16 - 1) - channel;
-    uint8_t *index12p = tlc_GSData + ((((uint16_t)index8) * 3) >> 1);
-    return (index8 & 1)? // starts in the middle
-            (((uint16_t)(*index12p & 15)) << 8) | // upper 4 bits
-            *(index12p + 1)                       // lower 8 bits
-        : // starts clean
-            (((uint16_t)(*index12p)) << 4) | // upper 8 bits
-            ((*(index12p + 1) & 0xF0) >> 4); // lower 4 bits
-    // that's probably the ugliest ternary operator I've ever created.
+    return tlc_getPacked(tlc_GSData, index8);
 }
 
 /** Sets all channels to value.
     \param value grayscale value (0 - 4095) */
 void Tlc5940::setAll(uint16_t value)
 {
-    uint8_t firstByte = value >> 4;
-    uint8_t secondByte = (value << 4) | (value >> 8);
-    uint8_t *p = tlc_GSData;
-    while (p < tlc_GSData + NUM_TLCS * 24) {
-        *p++ = firstByte;
-        *p++ = secondByte;
-        *p++ = (uint8_t)value;
+    tlc_setAllPacked(tlc_GSData, tlc_GSData + NUM_TLCS * 24, value);
+    tlc_markGSDirty();
+}
+
+/** Sets count channels from firstChannel up to values[0] ... values[count - 1].
+    Pairs of channels that share bytes are packed straight into their
+    #GS_DUO, so this is a lot faster than calling set() for each channel when
+    writing a whole frame.
+    \param firstChannel the channel for values[0]
+    \param values grayscale values (0 - 4095)
+    \param count number of values, firstChannel + count can't be more than
+           #NUM_TLCS * 16
+    \see tlc_setRangeFromProgmem */
+void Tlc5940::setRange(TLC_CHANNEL_TYPE firstChannel, const uint16_t *values,
+                       uint16_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    uint16_t channel = firstChannel;
+    if (channel & 1) { // shares its GS_DUO with a channel that isn't set
+        set(channel++, *values++);
+        count--;
+    }
+    uint8_t *p = tlc_duoOf(channel + 1) + 3;
+    uint8_t changed = 0;
+    while (count >= 2) { // higher channels are earlier in tlc_GSData
+        p -= 3;
+        changed |= tlc_setDuo(p, values[1], values[0]);
+        values += 2;
+        channel += 2;
+        count -= 2;
+    }
+    if (changed) {
+        tlc_markGSDirty();
+    }
+    if (count) {
+        set(channel, *values);
     }
 }
 
@@ -284,11 +549,12 @@ void Tlc5940::setAllDC(uint8_t value)
     uint8_t secondByte = value << 4 | value >> 2;
     uint8_t thirdByte = value << 6 | value;
 
-    for (TLC_CHANNEL_TYPE i = 0; i < NUM_TLCS * 12; i += 3) {
+    for (TLC_CHANNEL_TYPE i = 0; i < TLC_CHAIN_TLCS * 12; i += 3) {
         tlc_shift8(firstByte);
         tlc_shift8(secondByte);
         tlc_shift8(thirdByte);
     }
+    tlc_shift8_wait();
     pulse_pin(XLAT_PORT, XLAT_PIN);
 
     tlc_dcModeStop();
@@ -350,12 +616,128 @@ void tlc_shift8_init(void)
          | _BV(MSTR);  // master mode
 }
 
-/** Shifts out a byte, MSB first */
+/** Shifts out a byte, MSB first.  For more than a few bytes use
+    tlc_spiNext8(), which doesn't leave the SPI idle between bytes. */
 void tlc_shift8(uint8_t byte)
 {
+    tlc_host_cycles(TLC_HOST_CALL_CYCLES);
     SPDR = byte; // starts transmission
     while (!(SPSR & _BV(SPIF)))
         ; // wait for transmission complete
+    tlc_host_cycles(TLC_HOST_RETURN_CYCLES);
+}
+
+#elif DATA_TRANSFER_MODE == TLC_USART_SPI
+
+/** Sets up the USART as an SPI master at full speed (f_osc / 2), SPI mode 0,
+    MSB first */
+void tlc_shift8_init(void)
+{
+    TLC_UBRR = 0;
+    SIN_DDR |= _BV(SIN_PIN);   // TXD as output
+    SCLK_DDR |= _BV(SCLK_PIN); // XCK as output (master)
+    SCLK_PORT &= ~_BV(SCLK_PIN);
+    TLC_UCSRC = _BV(TLC_UMSEL1) | _BV(TLC_UMSEL0); // master SPI mode
+    TLC_UCSRB = _BV(TLC_TXEN); // transmitter only
+    TLC_UBRR = 0;              // baud rate has to be set after enabling
+}
+
+/** Loads a byte into the transmit buffer, MSB first.  Returns as soon as
+    there's room for it, call tlc_shift8_wait() before the next XLAT. */
+void tlc_shift8(uint8_t byte)
+{
+    while (!(TLC_UCSRA & _BV(TLC_UDRE)))
+        ; // wait for room in the transmit buffer
+    TLC_UDR = byte;
+    TLC_UCSRA = _BV(TLC_TXC); // clears TXC (after UDR is loaded, so the byte
+                              // before can't set it again)
+}
+
+#elif DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+
+/** The SIN pins of all the chains */
+#define PARALLEL_SIN_MASK \
+        ((uint8_t)(((1 << TLC_NUM_CHAINS) - 1) << PARALLEL_SIN_FIRST_PIN))
+
+/** Sets SCLK and the SIN pin of every chain to output */
+void tlc_shift8_init(void)
+{
+    PARALLEL_SIN_DDR |= PARALLEL_SIN_MASK; // every SIN as output
+    SCLK_DDR |= _BV(SCLK_PIN);             // SCLK as output
+    SCLK_PORT &= ~_BV(SCLK_PIN);
+}
+
+/** Shifts the same byte into every chain, MSB first */
+void tlc_shift8(uint8_t byte)
+{
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+        if (bit & byte) {
+            PARALLEL_SIN_PORT |= PARALLEL_SIN_MASK;
+        } else {
+            PARALLEL_SIN_PORT &= ~PARALLEL_SIN_MASK;
+        }
+        pulse_pin(SCLK_PORT, SCLK_PIN);
+    }
+}
+
+/** Shifts bytes[n] into chain n, MSB first.  Each bit is transposed into
+    one write of #PARALLEL_SIN_PORT, so every chain gets its bit on the same
+    SCLK pulse.
+    \param bytes TLC_NUM_CHAINS bytes, used as scratch space (they're all 0
+           after the call) */
+void tlc_shift8Chains(uint8_t *bytes)
+{
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        uint8_t sins = 0;
+        uint8_t *p = bytes + TLC_NUM_CHAINS;
+        while (p > bytes) { // the MSB of each byte, last chain first
+            uint8_t byte = *--p;
+            sins = (sins << 1) | (byte >> 7);
+            *p = byte << 1;
+        }
+        PARALLEL_SIN_PORT = (PARALLEL_SIN_PORT & ~PARALLEL_SIN_MASK)
+                          | (sins << PARALLEL_SIN_FIRST_PIN);
+        pulse_pin(SCLK_PORT, SCLK_PIN);
+    }
+}
+
+#endif
+
+#if TLC_PWM_TICKS
+
+#if defined(TLC_ATMEGA_8_H)
+#define TLC_TIFR1    TIFR
+#else
+#define TLC_TIFR1    TIFR1
+#endif
+
+/** Makes the Timer1 overflow interrupt handle the XLAT pulse at the end of
+    this period (set_XLAT_interrupt()).  An overflow that is already pending
+    ended a period before the XLAT pulses were enabled, so it's cleared (as
+    set_XLAT_interrupt() does without #TLC_PWM_TICKS) and counted here
+    instead of being taken for the latch. */
+void tlc_armXLAT(void)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    if (TLC_TIFR1 & _BV(TOV1)) {
+        TLC_TIFR1 = _BV(TOV1); // cleared by writing a one
+        tlc_pwmTicks++;
+    }
+    tlc_XLATArmed = 1;
+    SREG = oldSREG;
+}
+
+/** Reads #tlc_pwmTicks with interrupts off, so the interrupt can't change it
+    between bytes.
+    \returns PWM periods since Tlc.init() */
+uint32_t tlc_getPwmTicks(void)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    uint32_t ticks = tlc_pwmTicks;
+    SREG = oldSREG;
+    return ticks;
 }
 
 #endif
@@ -365,6 +747,7 @@ void tlc_shift8(uint8_t byte)
 /** Switches to dot correction mode and clears any waiting grayscale latches.*/
 void tlc_dcModeStart(void)
 {
+    tlc_waitForTransfer(); // tlc_shift8 can't share the SPI with the interrupt
     disable_XLAT_pulses(); // ensure that no latches happen
     clear_XLAT_interrupt(); // (in case this was called right after update)
     tlc_needXLAT = 0;
@@ -426,8 +809,13 @@ Tlc5940 Tlc;
             channels to value. (Needs Tlc.update())
     - \link Tlc5940::get uint16_t Tlc.get(uint8_t channel)\endlink - returns
             the grayscale data for channel (see set).
+    - \link Tlc5940::setRange Tlc.setRange(uint8_t firstChannel,
+            const uint16_t *values, uint16_t count)\endlink - sets count
+            channels from an array. (Needs Tlc.update())
     - \link Tlc5940::update Tlc.update()\endlink - Sends the changes from any
             Tlc.clear's, Tlc.set's, or Tlc.setAll's.
+    - \link Tlc5940::commit Tlc.commit()\endlink - Swaps in the back buffer
+            and sends it without waiting (requires TLC_DOUBLE_BUFFER).
 
     \ref ExtendedFunctions "Extended Functions".  These require an include
     statement at the top of the sketch to use.
@@ -25,7 +25,15 @@
 #include <stdint.h>
 #include "tlc_config.h"
 
-#ifdef TLC_ATMEGA_8_H
+#if TLC_PWM_TICKS
+
+/** The Timer1 Overflow interrupt is always enabled to count #tlc_pwmTicks,
+    this makes it handle the XLAT pulse at the end of this period */
+#define set_XLAT_interrupt()    tlc_armXLAT()
+/** Makes the Timer1 Overflow interrupt only count #tlc_pwmTicks */
+#define clear_XLAT_interrupt()  tlc_XLATArmed = 0
+
+#elif defined(TLC_ATMEGA_8_H)
 
 /** Enables the Timer1 Overflow interrupt, which will fire after an XLAT
     pulse */
@@ -48,9 +56,64 @@
 /** Disables the output of XLAT pulses */
 #define disable_XLAT_pulses()   TCCR1A = _BV(COM1B1)
 
+#if TLC_ASYNC_UPDATE
+/** Waits until the SPI interrupt has shifted out the last byte of an update */
+#define tlc_waitForTransfer()   while (SPCR & _BV(SPIE))
+#else
+/** Transfers are finished by the time Tlc.update() returns */
+#define tlc_waitForTransfer()
+#endif
+
+#if !defined(TLC_HOST)
+/** Cycle estimate for the host register mock (pinouts/Host.h), nothing on a
+    real chip */
+#define tlc_host_cycles(cycles)
+#endif
+
+#if DATA_TRANSFER_MODE == TLC_USART_SPI
+/** Waits until the last byte given to tlc_shift8() has left the USART */
+#define tlc_shift8_wait()       while (!(TLC_UCSRA & _BV(TLC_TXC)))
+#else
+/** tlc_shift8() only returns after the byte is shifted out */
+#define tlc_shift8_wait()
+#endif
+
+#if TLC_DIRTY_TRACKING
+/** Tells Tlc.update() that #tlc_GSData has changed.  Only needed by code that
+    writes #tlc_GSData directly. */
+#define tlc_markGSDirty()       tlc_GSDirty = 1
+#else
+/** Every update shifts out the data, so there's nothing to mark */
+#define tlc_markGSDirty()
+#endif
+
+#if TLC_DOUBLE_BUFFER
+/** Shows the frame in #tlc_GSData: Tlc.commit(), which never drops it */
+#define tlc_present()           Tlc.commit()
+#else
+/** Shows the frame in #tlc_GSData: Tlc.update(), which does nothing if the
+    last frame is still waiting for its XLAT */
+#define tlc_present()           Tlc.update()
+#endif
+
 extern volatile uint8_t tlc_needXLAT;
+#if TLC_DIRTY_TRACKING
+extern volatile uint8_t tlc_GSDirty;
+extern volatile uint32_t tlc_skippedUpdates;
+#endif
 extern volatile void (*tlc_onUpdateFinished)(void);
+#if TLC_PWM_TICKS
+extern volatile uint8_t tlc_XLATArmed;
+extern volatile uint32_t tlc_pwmTicks;
+#endif
+#if TLC_DOUBLE_BUFFER
+extern uint8_t *tlc_GSData;
+extern uint8_t *tlc_GSFront;
+#else
 extern uint8_t tlc_GSData[NUM_TLCS * 24];
+/** Without TLC_DOUBLE_BUFFER the shifted out data is #tlc_GSData itself */
+#define tlc_GSFront    tlc_GSData
+#endif
 
 /** The main Tlc5940 class for the entire library.  An instance of this class
     will be preinstantiated as Tlc. */
@@ -60,9 +123,14 @@ class Tlc5940
     void init(uint16_t initialValue = 0);
     void clear(void);
     uint8_t update(void);
+#if TLC_DOUBLE_BUFFER
+    void commit(void);
+#endif
     void set(TLC_CHANNEL_TYPE channel, uint16_t value);
     uint16_t get(TLC_CHANNEL_TYPE channel);
     void setAll(uint16_t value);
+    void setRange(TLC_CHANNEL_TYPE firstChannel, const uint16_t *values,
+                  uint16_t count);
 #if VPRG_ENABLED
     void setAllDC(uint8_t value);
 #endif
@@ -74,6 +142,130 @@ class Tlc5940
 
 void tlc_shift8_init(void);
 void tlc_shift8(uint8_t byte);
+#if TLC_PWM_TICKS
+void tlc_armXLAT(void);
+uint32_t tlc_getPwmTicks(void);
+#endif
+
+/** Writes an odd channel and the even channel below it (the 3 bytes of a
+    #GS_DUO) without reading them back, unless #TLC_DIRTY_TRACKING has to
+    know if they changed.
+    \param p the #GS_DUO in #tlc_GSData, see tlc_duoOf()
+    \param oddValue value (0 - 4095) of the odd channel
+    \param evenValue value (0 - 4095) of the channel below it
+    \returns 0 if the #GS_DUO already held both values (only with
+             #TLC_DIRTY_TRACKING), 1 otherwise */
+static inline uint8_t tlc_setDuo(uint8_t *p, uint16_t oddValue,
+                                 uint16_t evenValue)
+{
+    uint8_t b0 = oddValue >> 4;
+    uint8_t b1 = ((uint8_t)(oddValue << 4)) | (evenValue >> 8);
+    uint8_t b2 = (uint8_t)evenValue;
+#if TLC_DIRTY_TRACKING
+    if (p[0] == b0 && p[1] == b1 && p[2] == b2) {
+        return 0; // no change
+    }
+#endif
+    p[0] = b0;
+    p[1] = b1;
+    p[2] = b2;
+    return 1;
+}
+
+/** The #GS_DUO in #tlc_GSData that holds oddChannel and oddChannel - 1 */
+#define tlc_duoOf(oddChannel) \
+        (tlc_GSData + ((NUM_TLCS * 16 - 1) - (oddChannel)) / 2 * 3)
+
+/** Writes a channel into packed grayscale data in the format of
+    #tlc_GSData.  Tlc.set() and Tlc5940Chain::set() (tlc_chain.h) are this
+    with their own buffer.
+    \param data the packed data of a chain
+    \param index8 the channel counted from the end of the chain
+           (channels - 1 - channel)
+    \param value (0 - 4095)
+    \returns 0 if the channel already had value (only with
+             #TLC_DIRTY_TRACKING, which skips the write), 1 otherwise */
+static inline uint8_t tlc_setPacked(uint8_t *data, uint16_t index8,
+                                    uint16_t value)
+{
+    uint8_t *index12p = data + ((index8 * 3) >> 1);
+    uint8_t firstByte, secondByte;
+    if (index8 & 1) { // starts in the middle
+                      // first 4 bits intact | 4 top bits of value
+        firstByte = (*index12p & 0xF0) | (value >> 8);
+                      // 8 lower bits of value
+        secondByte = value & 0xFF;
+    } else { // starts clean
+                      // 8 upper bits of value
+        firstByte = value >> 4;
+                      // 4 lower bits of value | last 4 bits intact
+        secondByte = ((uint8_t)(value << 4)) | (*(index12p + 1) & 0xF);
+    }
+#if TLC_DIRTY_TRACKING
+    if (*index12p == firstByte && *(index12p + 1) == secondByte) {
+        return 0; // no change
+    }
+#endif
+    *index12p = firstByte;
+    *(index12p + 1) = secondByte;
+    return 1;
+}
+
+/** Reads a channel from packed grayscale data, see tlc_setPacked().
+    \returns grayscale value (0 - 4095) */
+static inline uint16_t tlc_getPacked(const uint8_t *data, uint16_t index8)
+{
+    const uint8_t *index12p = data + ((index8 * 3) >> 1);
+    return (index8 & 1)? // starts in the middle
+            (((uint16_t)(*index12p & 15)) << 8) | // upper 4 bits
+            *(index12p + 1)                       // lower 8 bits
+        : // starts clean
+            (((uint16_t)(*index12p)) << 4) | // upper 8 bits
+            ((*(index12p + 1) & 0xF0) >> 4); // lower 4 bits
+    // that's probably the ugliest ternary operator I've ever created.
+}
+
+/** Sets every channel of packed grayscale data to value (0 - 4095).
+    \param data the packed data of a chain
+    \param end data + 24 * the TLCs in the chain */
+static inline void tlc_setAllPacked(uint8_t *data, uint8_t *end,
+                                    uint16_t value)
+{
+    uint8_t firstByte = value >> 4;
+    uint8_t secondByte = (value << 4) | (value >> 8);
+    while (data < end) {
+        *data++ = firstByte;
+        *data++ = secondByte;
+        *data++ = (uint8_t)value;
+    }
+}
+
+#if DATA_TRANSFER_MODE == TLC_SPI
+
+/** Waits for the byte on the wire, then starts the next one.  Callers load
+    byte before this (start the first byte with SPDR = ...), so the load and
+    the loop overhead happen while the previous byte is being shifted out
+    and the SPI doesn't sit idle between bytes.  Finish with
+    tlc_spiWait(). */
+static inline void tlc_spiNext8(uint8_t byte)
+{
+    tlc_host_cycles(TLC_HOST_LOAD_CYCLES); // while the byte is out
+    while (!(SPSR & _BV(SPIF)))
+        ; // wait for transmission complete
+    SPDR = byte;
+}
+
+/** Waits for the last byte started with tlc_spiNext8() */
+static inline void tlc_spiWait(void)
+{
+    while (!(SPSR & _BV(SPIF)))
+        ; // wait for transmission complete
+}
+
+#endif
+#if DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+void tlc_shift8Chains(uint8_t *bytes);
+#endif
 
 #if VPRG_ENABLED
 void tlc_dcModeStart(void);
@@ -0,0 +1,45 @@
+/*
+    The BasicAnimations "Arduino" POV animation, compressed: ani_arduino_z.h
+    is 642 bytes instead of 1920.
+
+    ani_arduino_z.h was made from the BasicAnimations ani_arduino.h with the
+    included python script:
+        python tlc_encode_animation.py ../BasicAnimations/ani_arduino.h > ani_arduino_z.h
+    Add -n <NUM_TLCS> for animations made for more than 1 TLC, and
+    -k <frames> to put a keyframe every <frames> frames.
+
+    Animations that hold still, fade a few channels at a time or leave most
+    channels dark compress best (often 10x or more).
+
+    See the BasicUse example for hardware setup. */
+
+#include "Tlc5940.h"
+#include "tlc_animations.h"
+#include "ani_arduino_z.h"
+
+void setup()
+{
+  Tlc.init();
+}
+
+void loop()
+{
+  // checks to see if the animation is finished playing
+  if (!tlc_onUpdateFinished) {
+
+    delay(100);
+
+    /*
+      uint8_t tlc_playCompressedAnimation(prog_uint8_t *animation,
+                                          uint16_t periodsPerFrame);
+      The number of frames is in the animation.  Returns 0 (and doesn't
+      play anything) if the animation was encoded for a different NUM_TLCS.
+
+      Plays an animation in the "background", like tlc_playAnimation().
+      Don't call Tlc.update() while this is running. */
+    tlc_playCompressedAnimation(ani_arduino_z, 3);
+
+  }
+
+}
+
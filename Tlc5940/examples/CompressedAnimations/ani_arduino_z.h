@@ -0,0 +1,30 @@
+#define  ANI_ARDUINO_Z_BYTES  642
+uint8_t ani_arduino_z[ANI_ARDUINO_Z_BYTES] PROGMEM = {
+  80,0,24,0,202,9,70,11,48,234,15,176,234,11,48,72,194,72,4,8,16,255,15,240,
+  134,2,8,80,0,71,15,69,15,240,255,8,224,33,0,80,32,8,176,254,15,240,72,71,
+  3,179,15,240,142,199,3,138,15,240,180,71,3,234,15,240,33,71,3,32,15,240,235,71,
+  3,251,15,240,5,71,3,4,15,240,251,71,3,234,15,240,32,71,3,31,15,240,235,71,
+  3,179,15,240,137,71,3,136,15,240,181,71,15,72,15,240,254,8,128,31,0,64,31,8,
+  128,254,15,240,74,200,4,8,80,255,15,240,134,2,8,144,0,202,9,73,11,80,235,15,
+  176,235,11,80,74,194,215,87,72,8,3,32,173,14,144,253,15,240,255,133,71,5,57,15,
+  144,255,15,240,137,71,6,186,15,240,202,2,240,3,200,71,3,241,15,240,47,203,71,3,
+  250,15,240,4,75,71,3,208,15,240,24,75,71,3,100,15,240,111,75,200,5,9,64,246,
+  6,48,13,72,71,2,255,15,240,140,87,215,87,87,87,2,15,240,255,68,2,255,15,240,
+  140,87,215,87,87,71,2,255,15,240,140,87,208,6,13,6,32,246,9,80,0,211,3,111,
+  15,240,102,83,3,23,15,240,206,83,3,4,15,240,246,83,3,46,15,240,242,80,6,3,
+  2,224,201,15,240,186,71,2,255,15,240,138,1,144,57,80,6,253,14,144,173,3,32,0,
+  215,87,87,87,2,15,240,255,148,87,199,15,5,10,112,248,7,96,27,0,64,27,7,64,
+  247,10,112,6,71,3,130,15,240,103,199,3,100,15,240,131,71,3,226,15,240,14,71,3,
+  13,15,240,223,71,0,250,77,0,249,71,3,221,15,240,100,71,3,98,15,240,222,71,15,
+  125,15,240,247,7,48,26,0,48,26,7,16,246,15,240,126,71,5,6,11,0,255,15,240,
+  134,2,11,16,6,201,13,16,90,11,176,237,15,192,237,11,176,90,0,16,0,215,71,2,
+  253,15,240,76,71,3,248,15,240,1,75,71,3,208,15,240,25,75,71,3,109,15,240,115,
+  75,71,8,2,9,224,248,7,32,24,0,16,70,71,2,255,15,240,140,87,215,87,83,3,
+  16,6,160,206,80,6,64,10,48,246,15,240,255,75,11,1,144,121,13,176,255,15,240,254,
+  11,160,86,71,12,4,4,224,178,15,192,255,15,240,255,8,32,32,194,68,9,36,8,112,
+  230,15,240,255,15,144,170,66,197,65,12,93,12,0,255,15,240,255,13,80,114,1,64,0,
+  72,65,6,255,15,240,243,9,208,57,196,73,70,1,192,56,78,65,11,94,12,16,255,15,
+  240,255,13,64,113,1,48,73,196,9,37,8,128,231,15,240,255,15,144,169,72,199,6,4,
+  4,240,179,15,192,255,66,2,8,32,33,66,203,11,1,160,122,13,192,255,15,240,254,11,
+  192,89,207,7,16,65,10,64,247,15,240,255,211,3,16,6,176,206,
+};
@@ -0,0 +1,103 @@
+#!/usr/bin/env python
+# Compresses an animation for tlc_playCompressedAnimation() (tlc_animations.h).
+#
+#   python tlc_encode_animation.py ani_arduino.h > ani_arduino_z.h
+#
+# The input is a .h made by AnimationCreator: a "#define NAME_FRAMES n" and a
+# PROGMEM array of NUM_TLCS * 24 bytes a frame, last frame first (the order
+# tlc_playAnimation() wants).  Use --forward for an array in playing order.
+# The output is a .h with the array NAME_z and NAME_Z_BYTES (its length).
+
+import optparse
+import re
+import sys
+
+COPY = 0x00
+SKIP = 0x40
+REPEAT = 0x80
+ZERO = 0xC0
+MAX_RUN = 64
+
+def readAnimation(text):
+    """Returns (name, frames, data) from an AnimationCreator .h file."""
+    define = re.search(r'#define\s+(\w+)_FRAMES\s+(\d+)', text)
+    array = re.search(r'(\w+)\s*\[[^\]]*\]\s*PROGMEM\s*=\s*\{([^}]*)\}', text)
+    if not define or not array:
+        raise ValueError('no NAME_FRAMES define or PROGMEM array found')
+    data = [int(x, 0) for x in array.group(2).replace(',', ' ').split()]
+    return array.group(1), int(define.group(2)), data
+
+def encodeFrame(frame, last):
+    """Returns the fewest bytes of ops that turn last into frame (last is
+    None for a keyframe)."""
+    n = len(frame)
+    cost = [0] + [None] * n  # cost[i]: bytes to encode frame[:i]
+    choice = [None] * (n + 1)
+    for i in range(n):
+        for j in range(i + 1, min(i + MAX_RUN, n) + 1):
+            run = frame[i:j]
+            options = [(1 + len(run), COPY)]
+            if last is not None and run == last[i:j]:
+                options.append((1, SKIP))
+            if run.count(0) == len(run):
+                options.append((1, ZERO))
+            if i >= 3 and run == frame[i - 3:j - 3]:
+                options.append((1, REPEAT))
+            for c, op in options:
+                if cost[j] is None or cost[i] + c < cost[j]:
+                    cost[j] = cost[i] + c
+                    choice[j] = (i, op)
+    ops = []
+    j = n
+    while j:
+        i, op = choice[j]
+        run = [op | (j - i - 1)]
+        if op == COPY:
+            run += frame[i:j]
+        ops = run + ops
+        j = i
+    return ops
+
+def encode(frames, frameBytes, keyframeInterval):
+    out = [len(frames) & 0xFF, len(frames) >> 8,
+           frameBytes & 0xFF, frameBytes >> 8]
+    last = None
+    for i, frame in enumerate(frames):
+        if keyframeInterval and i % keyframeInterval == 0:
+            last = None
+        out += encodeFrame(frame, last)
+        last = frame
+    return out
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] animation.h')
+    parser.add_option('-n', '--num-tlcs', type='int', default=1,
+                      help='NUM_TLCS the animation is for [%default]')
+    parser.add_option('-k', '--keyframe-interval', type='int', default=0,
+                      help='a keyframe every this many frames (0: only the '
+                           'first) [%default]')
+    parser.add_option('--forward', action='store_true',
+                      help='the input array is in playing order')
+    options, args = parser.parse_args()
+    if len(args) != 1:
+        parser.error('expected one animation.h')
+    name, frameCount, data = readAnimation(open(args[0]).read())
+    frameBytes = options.num_tlcs * 24
+    if len(data) != frameCount * frameBytes:
+        parser.error('%d bytes is not %d frames of %d bytes'
+                     % (len(data), frameCount, frameBytes))
+    frames = [data[i * frameBytes:(i + 1) * frameBytes]
+              for i in range(frameCount)]
+    if not options.forward:
+        frames.reverse()
+    out = encode(frames, frameBytes, options.keyframe_interval)
+    sys.stderr.write('%s: %d bytes -> %d bytes (%.1fx)\n'
+                     % (name, len(data), len(out), len(data) / float(len(out))))
+    print('#define  %s_Z_BYTES  %d' % (name.upper(), len(out)))
+    print('uint8_t %s_z[%s_Z_BYTES] PROGMEM = {' % (name, name.upper()))
+    for i in range(0, len(out), 24):
+        print('  ' + ','.join(str(b) for b in out[i:i + 24]) + ',')
+    print('};')
+
+if __name__ == '__main__':
+    main()
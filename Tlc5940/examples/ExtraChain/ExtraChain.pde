@@ -0,0 +1,47 @@
+/*
+    Drives a second daisy-chain of TLCs next to Tlc, with its own SIN and
+    SCLK pins.  Tlc runs a light up its channels and the panel runs one back
+    down its own.
+
+    Panel pin setup (everything else like the BasicUse example):
+    -  digital 2        -> SIN (pin 26) of the first TLC of the panel
+    -  digital 5        -> SCLK (pin 25) of every TLC of the panel
+    -  GND              -> VPRG (pin 27) of every TLC of the panel
+    -  BLANK, XLAT and GSCLK are shared with the TLCs of Tlc: they all latch
+         on the same XLAT pulse.
+
+    The panel's size is set here, not in tlc_config.h, so it can be a
+    different length than NUM_TLCS. */
+
+#include "Tlc5940.h"
+#include "tlc_chain.h"
+
+TLC_CHAIN_PIN(PanelSin, PORTD, DDRD, PD2);   // Arduino digital pin 2
+TLC_CHAIN_PIN(PanelSclk, PORTD, DDRD, PD5);  // Arduino digital pin 5
+
+/* Tlc5940Chain<number of TLCs, how the bytes are shifted out> */
+Tlc5940Chain<2, TlcBitBang<PanelSin, PanelSclk> > panel;
+
+void setup()
+{
+  Tlc.init();
+  panel.init();
+}
+
+void loop()
+{
+  for (int i = 0; i < NUM_TLCS * 16 || i < panel.numChannels; i++) {
+    Tlc.clear();
+    Tlc.set(i % (NUM_TLCS * 16), 4095);
+
+    panel.clear();
+    panel.set(panel.numChannels - 1 - i % panel.numChannels, 4095);
+
+    /* Each update() waits for the XLAT of the one before it, so the two
+       chains show their new frames one PWM period apart. */
+    while (Tlc.update());
+    while (panel.update());
+
+    delay(75);
+  }
+}
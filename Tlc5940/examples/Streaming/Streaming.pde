@@ -0,0 +1,41 @@
+/*
+    Plays frames sent over the serial port, so a long show doesn't have to
+    fit in flash.  Each frame is NUM_TLCS * 24 bytes in the same format as
+    the animations in BasicAnimations (see tlc_GSData), sent in playing
+    order.  Send them faster than they're shown: the FIFO holds
+    TLC_STREAM_FRAMES frames, and the show stalls (tlc_streamUnderruns goes
+    up) if it runs dry.
+
+    See the BasicUse example for hardware setup. */
+
+#include "Tlc5940.h"
+#include "tlc_stream.h"
+
+struct Tlc_StreamSource serialFrames;
+
+int16_t readSerial(uint8_t *buffer, uint16_t count)
+{
+  uint16_t available = Serial.available();
+  return Serial.readBytes((char *)buffer, min(count, available));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Tlc.init();
+  tlc_initStreamSource(&serialFrames, readSerial);
+
+  /*
+    void tlc_playStream(struct Tlc_FrameSource *source,
+                        uint16_t periodsPerFrame);
+    periods per frame is PWM periods, 1.024ms per frame.  The frames are
+    shown from the XLAT interrupt; loop() has to keep the FIFO full with
+    tlc_streamFill(). */
+  tlc_playStream(&serialFrames.source, 32);
+}
+
+void loop()
+{
+  tlc_streamFill();
+}
+
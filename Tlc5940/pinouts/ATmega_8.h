@@ -49,6 +49,14 @@
 #define DEFAULT_BB_SCLK_PORT    PORTD
 #define DEFAULT_BB_SCLK_DDR     DDRD
 
+/** SIN of the first chain (Arduino analog pin 0) for TLC_PARALLEL_BITBANG,
+    the next chains use analog pins 1 - 5 (up to 6 chains) */
+#define DEFAULT_PBB_SIN_FIRST_PIN   PC0
+#define DEFAULT_PBB_SIN_PORT        PORTC
+#define DEFAULT_PBB_SIN_DDR         DDRC
+/** The number of SIN pins from DEFAULT_PBB_SIN_FIRST_PIN up (PC6 is RESET) */
+#define DEFAULT_PBB_MAX_CHAINS      6
+
 /** MOSI (Arduino digital pin 11) -> SIN (TLC pin 26) */
 #define TLC_MOSI_PIN     PB3
 #define TLC_MOSI_PORT    PORTB
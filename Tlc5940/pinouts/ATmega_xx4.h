@@ -43,6 +43,14 @@
 #define DEFAULT_BB_SCLK_PORT    PORTB
 #define DEFAULT_BB_SCLK_DDR     DDRB
 
+/** SIN of the first chain (Sanguino analog pin 0) for TLC_PARALLEL_BITBANG,
+    the next chains use analog pins 1 - 7 (up to 8 chains) */
+#define DEFAULT_PBB_SIN_FIRST_PIN   PA0
+#define DEFAULT_PBB_SIN_PORT        PORTA
+#define DEFAULT_PBB_SIN_DDR         DDRA
+/** The number of SIN pins from DEFAULT_PBB_SIN_FIRST_PIN up */
+#define DEFAULT_PBB_MAX_CHAINS      8
+
 /** MOSI (Sanguino digital pin 5) -> SIN (TLC pin 26) */
 #define TLC_MOSI_PIN     PB5
 #define TLC_MOSI_PORT    PORTB
@@ -53,6 +61,29 @@
 #define TLC_SCK_PORT     PORTB
 #define TLC_SCK_DDR      DDRB
 
+/** XCK0 (Sanguino digital pin 0) -> SCLK (TLC pin 25) for TLC_USART_SPI */
+#define TLC_XCK_PIN      PB0
+#define TLC_XCK_PORT     PORTB
+#define TLC_XCK_DDR      DDRB
+
+/** TXD0 (Sanguino digital pin 9) -> SIN (TLC pin 26) for TLC_USART_SPI.
+    Serial can't be used at the same time. */
+#define TLC_TXD_PIN      PD1
+#define TLC_TXD_PORT     PORTD
+#define TLC_TXD_DDR      DDRD
+
+/** USART0 registers for TLC_USART_SPI */
+#define TLC_UDR          UDR0
+#define TLC_UCSRA        UCSR0A
+#define TLC_UCSRB        UCSR0B
+#define TLC_UCSRC        UCSR0C
+#define TLC_UBRR         UBRR0
+#define TLC_UDRE         UDRE0
+#define TLC_TXC          TXC0
+#define TLC_TXEN         TXEN0
+#define TLC_UMSEL1       UMSEL01
+#define TLC_UMSEL0       UMSEL00
+
 /** SS will be set to output as to not interfere with SPI master operation.
     If you have changed the pin-outs and the library doesn't seem to work
     or works intermittently, make sure this pin is set correctly.  This pin
@@ -43,6 +43,14 @@
 #define DEFAULT_BB_SCLK_PORT    PORTB
 #define DEFAULT_BB_SCLK_DDR     DDRB
 
+/** SIN of the first chain (Mega pin 22) for TLC_PARALLEL_BITBANG, the next
+    chains use Mega pins 23 - 29 (up to 8 chains) */
+#define DEFAULT_PBB_SIN_FIRST_PIN   PA0
+#define DEFAULT_PBB_SIN_PORT        PORTA
+#define DEFAULT_PBB_SIN_DDR         DDRA
+/** The number of SIN pins from DEFAULT_PBB_SIN_FIRST_PIN up */
+#define DEFAULT_PBB_MAX_CHAINS      8
+
 /** MOSI (Mega pin 51) -> SIN (TLC pin 26) */
 #define TLC_MOSI_PIN     PB2
 #define TLC_MOSI_PORT    PORTB
@@ -0,0 +1,926 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_HOST_H
+#define TLC_HOST_H
+
+/** \file
+    Register mock for building the library with a normal compiler on a
+    workstation (compile with -DTLC_HOST).  The pins are the same as
+    pinouts/ATmega_xx8.h.
+
+    Every i/o register is an instrumented variable in tlc_host().  Writes to
+    SPDR and to the SIN, SCLK, XLAT and VPRG pins drive a model of #NUM_TLCS
+    daisy-chained TLC5940s (split into TLC_NUM_CHAINS chains with
+    TLC_PARALLEL_BITBANG), and TLC_HOST_EXTRA_SIN_PIN and
+    TLC_HOST_EXTRA_SCLK_PIN drive one more chain for tlc_chain.h.  Nothing
+    runs in the background:
+    - tlc_host_runSPI() runs the SPI Serial Transfer Complete interrupt until
+      the SPI is idle.  Reading any register with interrupts enabled does the
+      same.
+    - tlc_host_pwmPeriod() ends a PWM period: the XLAT pulse (if enabled) and
+      the Timer1 overflow interrupt (if enabled).
+    - tlc_host().millis is what millis() returns.
+
+    The cycle counts are estimates: each register access costs one cycle per
+    byte, an SPI byte takes 8 bits * the SPI clock divider and entering plus
+    leaving an interrupt costs #TLC_HOST_ISR_CYCLES.  Work that doesn't touch
+    a register is only counted where the library adds a tlc_host_cycles()
+    estimate: every SPI shift8 function charges #TLC_HOST_CALL_CYCLES and
+    #TLC_HOST_RETURN_CYCLES, an inline SPI loop #TLC_HOST_LOAD_CYCLES per
+    byte. */
+
+#include <stdint.h>
+
+/* ---------------------------- avr-libc shims ----------------------------- */
+
+#define _BV(bit)    (1 << (bit))
+
+#define PROGMEM
+typedef uint8_t prog_uint8_t;
+typedef uint16_t prog_uint16_t;
+#define pgm_read_byte(address)    (*(const uint8_t *)(address))
+#define pgm_read_word(address)    (*(const uint16_t *)(address))
+typedef uintptr_t uint_farptr_t;
+#define pgm_read_byte_far(address)    (*(const uint8_t *)(address))
+#define pgm_get_far_address(var)      ((uint_farptr_t)&(var))
+
+#define ISR(vector)    extern "C" void vector(void)
+#define sei()          (tlc_host().sreg.value |= _BV(SREG_I), \
+                        tlc_host_runTimer1())
+#define cli()          (tlc_host().sreg.value &= ~_BV(SREG_I))
+
+extern "C" void TIMER1_OVF_vect(void) __attribute__((weak));
+extern "C" void SPI_STC_vect(void) __attribute__((weak));
+inline void tlc_host_runTimer1(void);
+
+/* Register bits (same as the ATmega168/328) */
+#define SREG_I      7
+
+#define SPIE        7
+#define SPE         6
+#define DORD        5
+#define MSTR        4
+#define CPOL        3
+#define CPHA        2
+#define SPR1        1
+#define SPR0        0
+#define SPIF        7
+#define WCOL        6
+#define SPI2X       0
+
+#define RXC0        7
+#define TXC0        6
+#define UDRE0       5
+#define RXEN0       4
+#define TXEN0       3
+#define UMSEL01     7
+#define UMSEL00     6
+#define UDORD0      2
+#define UCPHA0      1
+#define UCPOL0      0
+
+#define COM1A1      7
+#define COM1A0      6
+#define COM1B1      5
+#define COM1B0      4
+#define WGM11       1
+#define WGM10       0
+#define WGM13       4
+#define WGM12       3
+#define CS12        2
+#define CS11        1
+#define CS10        0
+#define TOIE1       0
+#define TOV1        0
+
+#define COM2A1      7
+#define COM2A0      6
+#define COM2B1      5
+#define COM2B0      4
+#define WGM21       1
+#define WGM20       0
+#define WGM22       3
+#define CS22        2
+#define CS21        1
+#define CS20        0
+
+#define PORTB0  0
+#define PORTB1  1
+#define PORTB2  2
+#define PORTB3  3
+#define PORTB4  4
+#define PORTB5  5
+#define PORTB6  6
+#define PORTB7  7
+#define PORTC0  0
+#define PORTC1  1
+#define PORTC2  2
+#define PORTC3  3
+#define PORTC4  4
+#define PORTC5  5
+#define PORTC6  6
+#define PORTC7  7
+#define PORTD0  0
+#define PORTD1  1
+#define PORTD2  2
+#define PORTD3  3
+#define PORTD4  4
+#define PORTD5  5
+#define PORTD6  6
+#define PORTD7  7
+
+/* ------------------------------ Registers -------------------------------- */
+
+/** Estimated cycles to enter and leave an interrupt (vector jmp, reti and a
+    minimal prologue/epilogue). */
+#define TLC_HOST_ISR_CYCLES    20
+
+/** Estimated cycles for one pass of a loop polling a status flag */
+#define TLC_HOST_POLL_CYCLES    3
+
+/** Estimated cycles to load a byte argument from ram and call a function
+    (ld, call) */
+#define TLC_HOST_CALL_CYCLES    6
+
+/** Estimated cycles to return from a function (ret) */
+#define TLC_HOST_RETURN_CYCLES  4
+
+/** Estimated cycles per byte of an unrolled loop that loads its bytes from
+    ram (ld, and a share of the compare and branch) */
+#define TLC_HOST_LOAD_CYCLES    3
+
+/** Which registers have side effects in the model */
+enum TlcHostRegisterId {
+    TLC_HOST_PLAIN = 0,
+    TLC_HOST_PORTB,
+    TLC_HOST_PORTC,
+    TLC_HOST_PORTD,
+    TLC_HOST_SPDR,
+    TLC_HOST_SPSR,
+    TLC_HOST_UDR0,
+    TLC_HOST_UCSR0A,
+    TLC_HOST_TIFR1,
+    TLC_HOST_SREG
+};
+
+inline void tlc_host_registerRead(uint8_t id);
+inline void tlc_host_registerWritten(uint8_t id, uint8_t oldValue);
+
+/** Access counts and cycle estimates, see tlc_host_resetStats() */
+struct TlcHostStats {
+    uint32_t reads;        /**< register reads */
+    uint32_t writes;       /**< register writes */
+    uint32_t spiBytes;     /**< bytes shifted out by the SPI or USART */
+    uint32_t spiCollisions;/**< SPDR writes while a byte was on the wire */
+    uint32_t sclkPulses;   /**< SCLK rising edges seen by the TLCs */
+    uint32_t xlatPulses;   /**< XLAT pulses seen by the TLCs */
+    uint32_t interrupts;   /**< interrupt vectors run */
+    uint64_t cpuCycles;    /**< cycles the cpu spent on i/o, waits and ISRs */
+    uint64_t cycles;       /**< elapsed cycles (includes background SPI) */
+};
+
+/** An instrumented 8 or 16 bit i/o register. */
+template <typename T>
+class TlcHostRegister
+{
+  public:
+    T value;
+    uint8_t id;
+
+    operator T()
+    {
+        tlc_host_registerRead(id);
+        countAccess();
+        return value;
+    }
+    TlcHostRegister &operator=(T newValue)
+    {
+        write(newValue);
+        return *this;
+    }
+    TlcHostRegister &operator|=(int bits)
+    {
+        countAccess();
+        write((T)(value | bits));
+        return *this;
+    }
+    TlcHostRegister &operator&=(int bits)
+    {
+        countAccess();
+        write((T)(value & bits));
+        return *this;
+    }
+    TlcHostRegister &operator^=(int bits)
+    {
+        countAccess();
+        write((T)(value ^ bits));
+        return *this;
+    }
+
+  private:
+    void countAccess(void);
+    void write(T newValue)
+    {
+        T oldValue = value;
+        value = newValue;
+        countAccess();
+        tlc_host_registerWritten(id, (uint8_t)oldValue);
+    }
+};
+
+/* ----------------------------- TLC5940 model ----------------------------- */
+
+/** Behavioral model of one TLC5940 */
+struct TlcHostTlc {
+    /** Input shift register, first bit in (OUT15's MSB) is the MSB of
+        input[0].  In dot correction mode only input[12] - input[23] (96 bits)
+        are in the chain. */
+    uint8_t input[24];
+    uint16_t gs[16];       /**< grayscale register, latched on XLAT */
+    uint8_t dc[16];        /**< dot correction register, latched on XLAT */
+};
+
+#ifndef TLC_NUM_CHAINS
+#define TLC_NUM_CHAINS    1
+#endif
+
+/** The number of TLCs in each chain */
+#define TLC_HOST_CHAIN_TLCS    (NUM_TLCS / TLC_NUM_CHAINS)
+
+/** TLC_HOST_CHAIN_TLCS daisy-chained TLC5940s.  tlcs[0] is attached to the
+    arduino, its SOUT goes to the SIN of tlcs[1], and so on. */
+struct TlcHostChain {
+    TlcHostTlc tlcs[TLC_HOST_CHAIN_TLCS];
+    uint8_t dcMode;        /**< VPRG is high */
+    uint8_t firstGSInput;  /**< the next grayscale XLAT needs an extra SCLK */
+    uint8_t gsStaged;      /**< staged[] is waiting for that extra SCLK */
+    uint16_t staged[TLC_HOST_CHAIN_TLCS][16];
+    uint32_t gsLatches;    /**< XLATs that updated the grayscale registers */
+    uint32_t dcLatches;    /**< XLATs that updated the dot correction */
+    uint8_t pendingBits;   /**< bits clocked in but not shifted yet */
+    uint8_t pendingCount;  /**< the number of pendingBits, see clock() */
+
+    /** First byte of the shift register in the current mode */
+    uint8_t first(void) { return dcMode ? 12 : 0; }
+
+    /** One SCLK rising edge.  The bits are collected and shifted a byte at a
+        time (a bit at a time takes the whole chain per SCLK, which made
+        bit-banged updates of long chains too slow to test); anything that
+        looks at the shift registers calls flush() first. */
+    void clock(uint8_t sin)
+    {
+        applyStaged();
+        pendingBits = (pendingBits << 1) | sin;
+        if (++pendingCount == 8) {
+            pendingCount = 0;
+            shift8(pendingBits);
+        }
+    }
+
+    /** Shifts in the bits clock() collected */
+    void flush(void)
+    {
+        while (pendingCount) {
+            pendingCount--;
+            shift((pendingBits >> pendingCount) & 1);
+        }
+    }
+
+    /** Every TLC shifts in one bit, the first one from SIN and the others
+        from the SOUT of the previous TLC. */
+    void shift(uint8_t sin)
+    {
+        for (uint8_t t = 0; t < TLC_HOST_CHAIN_TLCS; t++) {
+            uint8_t *p = tlcs[t].input + first();
+            uint8_t *end = tlcs[t].input + 24;
+            uint8_t sout = *p >> 7;
+            while (p < end - 1) {
+                *p = (*p << 1) | (*(p + 1) >> 7);
+                p++;
+            }
+            *p = (*p << 1) | sin;
+            sin = sout;
+        }
+    }
+
+    /** Eight SCLK pulses with the SPI */
+    void clock8(uint8_t byte)
+    {
+        applyStaged();
+        flush();
+        shift8(byte);
+    }
+
+    /** Shifts a whole byte into every TLC, MSB first */
+    void shift8(uint8_t byte)
+    {
+        for (uint8_t t = 0; t < TLC_HOST_CHAIN_TLCS; t++) {
+            uint8_t *p = tlcs[t].input + first();
+            uint8_t *end = tlcs[t].input + 24;
+            uint8_t sout = *p;
+            while (p < end - 1) {
+                *p = *(p + 1);
+                p++;
+            }
+            *p = byte;
+            byte = sout;
+        }
+    }
+
+    /** The SOUT of the last TLC in the chain */
+    uint8_t sout(void)
+    {
+        flush();
+        return tlcs[TLC_HOST_CHAIN_TLCS - 1].input[first()] >> 7;
+    }
+
+    /** XLAT rising edge: latches the shift register into the grayscale or
+        dot correction register. */
+    void latch(void)
+    {
+        flush();
+        for (uint8_t t = 0; t < TLC_HOST_CHAIN_TLCS; t++) {
+            uint8_t *in = tlcs[t].input;
+            for (uint8_t out = 0; out < 16; out++) {
+                if (dcMode) {
+                    uint8_t bit = (15 - out) * 6; // first bit of this output
+                    uint8_t *p = in + 12 + bit / 8;
+                    uint16_t word = ((uint16_t)(*p) << 8)
+                                  | (p < in + 23 ? *(p + 1) : 0);
+                    tlcs[t].dc[out] = (word >> (10 - bit % 8)) & 0x3F;
+                } else {
+                    uint8_t index8 = 15 - out;
+                    uint8_t *p = in + ((index8 * 3) >> 1);
+                    uint16_t value = (index8 & 1)?
+                            (((uint16_t)(*p & 15)) << 8) | *(p + 1)
+                          : (((uint16_t)(*p)) << 4) | (*(p + 1) >> 4);
+                    if (firstGSInput) {
+                        staged[t][out] = value;
+                    } else {
+                        tlcs[t].gs[out] = value;
+                    }
+                }
+            }
+        }
+        if (dcMode) {
+            dcLatches++;
+        } else if (firstGSInput) {
+            firstGSInput = 0;
+            gsStaged = 1;
+        } else {
+            gsLatches++;
+        }
+    }
+
+    /** The first grayscale data after dot correction only takes effect after
+        an extra SCLK pulse following the XLAT. */
+    void applyStaged(void)
+    {
+        if (gsStaged) {
+            for (uint8_t t = 0; t < TLC_HOST_CHAIN_TLCS; t++) {
+                for (uint8_t out = 0; out < 16; out++) {
+                    tlcs[t].gs[out] = staged[t][out];
+                }
+            }
+            gsStaged = 0;
+            gsLatches++;
+        }
+    }
+
+    /** VPRG level change */
+    void setVPRG(uint8_t high)
+    {
+        flush();
+        if (dcMode && !high) {
+            firstGSInput = 1;
+        }
+        dcMode = high;
+    }
+};
+
+/* ---------------------------- The ATmega168 ------------------------------ */
+
+/** All the registers the library uses, plus the TLC model */
+struct TlcHostMcu {
+    TlcHostRegister<uint8_t> sreg;
+    TlcHostRegister<uint8_t> portB, ddrB, pinB;
+    TlcHostRegister<uint8_t> portC, ddrC, pinC;
+    TlcHostRegister<uint8_t> portD, ddrD, pinD;
+    TlcHostRegister<uint8_t> spcr, spsr, spdr;
+    TlcHostRegister<uint8_t> ucsr0a, ucsr0b, ucsr0c, udr0;
+    TlcHostRegister<uint16_t> ubrr0;
+    TlcHostRegister<uint8_t> tccr1a, tccr1b, timsk1, tifr1;
+    TlcHostRegister<uint16_t> ocr1a, ocr1b, icr1, tcnt1;
+    TlcHostRegister<uint8_t> tccr2a, tccr2b, ocr2a, ocr2b, tcnt2;
+
+    TlcHostChain chains[TLC_NUM_CHAINS]; /**< all share SCLK, XLAT and VPRG */
+    /** A chain with its own SIN and SCLK (TLC_HOST_EXTRA_SIN_PIN,
+        TLC_HOST_EXTRA_SCLK_PIN) for a Tlc5940Chain, see tlc_chain.h.  It
+        latches on XLAT and its VPRG is tied to GND. */
+    TlcHostChain extraChain;
+    TlcHostStats stats;
+    uint64_t spiDoneAt;    /**< cycle when the byte on the wire is done */
+    uint8_t spiBusy;       /**< a byte is on the wire */
+    uint64_t usartDoneAt;  /**< cycle when the USART shift register is empty */
+    uint8_t usartBusy;     /**< the USART shift register has a byte */
+    uint8_t usartBuffered; /**< the USART transmit buffer has a byte */
+    uint8_t usartBuffer;   /**< the byte in the transmit buffer */
+    uint32_t pwmPeriods;   /**< calls to tlc_host_pwmPeriod() with Timer1 on */
+    uint32_t millis;       /**< returned by millis() */
+
+    TlcHostMcu(void)
+    {
+        uint8_t *p = (uint8_t *)this;
+        for (uint16_t i = 0; i < sizeof(*this); i++) {
+            *p++ = 0;
+        }
+        portB.id = TLC_HOST_PORTB;
+        portC.id = TLC_HOST_PORTC;
+        portD.id = TLC_HOST_PORTD;
+        spdr.id = TLC_HOST_SPDR;
+        spsr.id = TLC_HOST_SPSR;
+        udr0.id = TLC_HOST_UDR0;
+        ucsr0a.id = TLC_HOST_UCSR0A;
+        ucsr0a.value = _BV(UDRE0);
+        tifr1.id = TLC_HOST_TIFR1;
+        sreg.id = TLC_HOST_SREG;
+        sreg.value = _BV(SREG_I); // the arduino core enables interrupts
+    }
+
+    /** Cycles per SPI byte for the current SPCR/SPSR settings */
+    uint16_t spiByteCycles(void)
+    {
+        static const uint8_t dividers[4] = {4, 16, 64, 128};
+        uint16_t divider = dividers[spcr.value & (_BV(SPR1) | _BV(SPR0))];
+        if (spsr.value & _BV(SPI2X)) {
+            divider /= 2;
+        }
+        return divider * 8;
+    }
+
+    /** The USART is a master SPI with the transmitter on */
+    uint8_t usartSPI(void)
+    {
+        return (ucsr0c.value & (_BV(UMSEL01) | _BV(UMSEL00)))
+                   == (_BV(UMSEL01) | _BV(UMSEL00))
+               && (ucsr0b.value & _BV(TXEN0));
+    }
+
+    /** Cycles per USART byte: 8 bits at f_osc / (2 * (UBRR + 1)) */
+    uint32_t usartByteCycles(void)
+    {
+        return 16 * ((uint32_t)ubrr0.value + 1);
+    }
+
+    /** Catches the USART up with the clock: a finished byte makes room for
+        the buffered one, or sets TXC if there isn't one. */
+    void usartUpdate(void)
+    {
+        while (usartBusy && stats.cycles >= usartDoneAt) {
+            if (usartBuffered) {
+                usartBuffered = 0;
+                usartDoneAt += usartByteCycles();
+                stats.spiBytes++;
+                stats.sclkPulses += 8;
+                chains[0].clock8(usartBuffer);
+            } else {
+                usartBusy = 0;
+                ucsr0a.value |= _BV(TXC0);
+            }
+        }
+        if (usartBuffered) {
+            ucsr0a.value &= ~_BV(UDRE0);
+        } else {
+            ucsr0a.value |= _BV(UDRE0);
+        }
+    }
+
+    /** Advances the clock to the end of the byte on the wire */
+    void spiFinish(void)
+    {
+        if (spiBusy) {
+            if (stats.cycles < spiDoneAt) {
+                stats.cycles = spiDoneAt;
+            }
+            spiBusy = 0;
+            spsr.value |= _BV(SPIF);
+        }
+    }
+};
+
+/** The mock arduino. */
+inline TlcHostMcu &tlc_host(void)
+{
+    static TlcHostMcu mcu;
+    return mcu;
+}
+
+template <typename T>
+inline void TlcHostRegister<T>::countAccess(void)
+{
+    TlcHostStats &stats = tlc_host().stats;
+    stats.cpuCycles += sizeof(T);
+    stats.cycles += sizeof(T);
+}
+
+/** Estimated AVR cycles for code that doesn't touch a register (loads,
+    calls, loop overhead).  Work done while a byte is on the wire shortens
+    the wait for it. */
+inline void tlc_host_cycles(uint8_t cycles)
+{
+    TlcHostStats &stats = tlc_host().stats;
+    stats.cpuCycles += cycles;
+    stats.cycles += cycles;
+}
+
+inline void tlc_host_runSPI(void);
+
+/** Reading SPSR while a byte is on the wire is a polling loop: the cpu waits
+    until the byte is done.  Any other read gives a pending SPI interrupt the
+    chance to run, so loops like tlc_waitForTransfer() finish. */
+inline void tlc_host_registerRead(uint8_t id)
+{
+    TlcHostMcu &mcu = tlc_host();
+    mcu.stats.reads++;
+    tlc_host_runSPI();
+    if (id == TLC_HOST_SPSR && mcu.spiBusy) {
+        if (mcu.stats.cycles < mcu.spiDoneAt) {
+            mcu.stats.cpuCycles += mcu.spiDoneAt - mcu.stats.cycles;
+        }
+        mcu.spiFinish();
+    }
+    if (id == TLC_HOST_UCSR0A) {
+        mcu.usartUpdate();
+        if (mcu.usartBuffered) {
+            // polling UDRE: wait until the buffer moves to the shift register
+            mcu.stats.cpuCycles += mcu.usartDoneAt - mcu.stats.cycles;
+            mcu.stats.cycles = mcu.usartDoneAt;
+            mcu.usartUpdate();
+        } else if (mcu.usartBusy) {
+            // maybe polling TXC: one more time around the loop
+            mcu.stats.cpuCycles += TLC_HOST_POLL_CYCLES;
+            mcu.stats.cycles += TLC_HOST_POLL_CYCLES;
+        }
+    }
+}
+
+inline void tlc_host_pinWritten(TlcHostRegister<uint8_t> &port,
+                                uint8_t oldValue);
+
+inline void tlc_host_registerWritten(uint8_t id, uint8_t oldValue)
+{
+    TlcHostMcu &mcu = tlc_host();
+    mcu.stats.writes++;
+    switch (id) {
+        case TLC_HOST_PORTB:
+            tlc_host_pinWritten(mcu.portB, oldValue);
+            break;
+        case TLC_HOST_PORTC:
+            tlc_host_pinWritten(mcu.portC, oldValue);
+            break;
+        case TLC_HOST_PORTD:
+            tlc_host_pinWritten(mcu.portD, oldValue);
+            break;
+        case TLC_HOST_SPDR:
+            if (!((mcu.spcr.value & _BV(SPE)) && (mcu.spcr.value & _BV(MSTR)))) {
+                break; // SPI is off
+            }
+            if (mcu.spiBusy && mcu.stats.cycles < mcu.spiDoneAt) {
+                mcu.spsr.value |= _BV(WCOL);
+                mcu.stats.spiCollisions++;
+                break;
+            }
+            mcu.spiBusy = 1;
+            mcu.spiDoneAt = mcu.stats.cycles + mcu.spiByteCycles();
+            mcu.spsr.value &= ~(_BV(SPIF) | _BV(WCOL));
+            mcu.stats.spiBytes++;
+            mcu.stats.sclkPulses += 8;
+            mcu.chains[0].clock8(mcu.spdr.value);
+            break;
+        case TLC_HOST_UCSR0A:
+            // TXC is cleared by writing a one, UDRE is read only
+            mcu.ucsr0a.value = (oldValue & ~(mcu.ucsr0a.value & _BV(TXC0))
+                                         & (_BV(TXC0) | _BV(UDRE0)))
+                             | (mcu.ucsr0a.value & ~(_BV(TXC0) | _BV(UDRE0)));
+            break;
+        case TLC_HOST_TIFR1:
+            // flags are cleared by writing a one
+            mcu.tifr1.value = oldValue & ~mcu.tifr1.value;
+            break;
+        case TLC_HOST_SREG:
+            tlc_host_runTimer1(); // a pending overflow runs when I is set
+            break;
+        case TLC_HOST_UDR0:
+            if (!mcu.usartSPI()) {
+                break; // transmitter is off
+            }
+            mcu.usartUpdate();
+            if (!mcu.usartBusy) {
+                mcu.usartBusy = 1;
+                mcu.usartDoneAt = mcu.stats.cycles + mcu.usartByteCycles();
+                mcu.stats.spiBytes++;
+                mcu.stats.sclkPulses += 8;
+                mcu.chains[0].clock8(mcu.udr0.value);
+            } else if (!mcu.usartBuffered) {
+                mcu.usartBuffered = 1;
+                mcu.usartBuffer = mcu.udr0.value;
+            } else {
+                mcu.stats.spiCollisions++; // ignored, UDRE wasn't set
+            }
+            mcu.usartUpdate();
+            break;
+    }
+}
+
+/** XLAT rising edge on every chain */
+inline void tlc_host_latch(void)
+{
+    TlcHostMcu &mcu = tlc_host();
+    for (uint8_t c = 0; c < TLC_NUM_CHAINS; c++) {
+        mcu.chains[c].latch();
+    }
+    mcu.extraChain.latch();
+}
+
+/** Runs the SPI interrupt until the SPI is idle or the interrupt is
+    disabled. */
+inline void tlc_host_runSPI(void)
+{
+    TlcHostMcu &mcu = tlc_host();
+    while (mcu.spiBusy && (mcu.spcr.value & _BV(SPIE))
+           && (mcu.sreg.value & _BV(SREG_I))) {
+        mcu.spiFinish();
+        mcu.spsr.value &= ~_BV(SPIF); // cleared by running the vector
+        if (!SPI_STC_vect) {
+            break;
+        }
+        mcu.stats.interrupts++;
+        mcu.stats.cpuCycles += TLC_HOST_ISR_CYCLES;
+        mcu.stats.cycles += TLC_HOST_ISR_CYCLES;
+        mcu.sreg.value &= ~_BV(SREG_I);
+        SPI_STC_vect();
+        mcu.sreg.value |= _BV(SREG_I);
+    }
+}
+
+/** Ends a PWM period (if Timer1 is running): XLAT pulse if XLAT pulses are
+    enabled, then the Timer1 overflow interrupt if it's enabled. */
+inline void tlc_host_pwmPeriod(void)
+{
+    TlcHostMcu &mcu = tlc_host();
+    tlc_host_runSPI();
+    if (!(mcu.tccr1b.value & (_BV(CS12) | _BV(CS11) | _BV(CS10)))) {
+        return;
+    }
+    mcu.pwmPeriods++;
+    if (mcu.tccr1a.value & _BV(COM1A1)) {
+        mcu.stats.xlatPulses++;
+        tlc_host_latch();
+    }
+    mcu.tifr1.value |= _BV(TOV1);
+    tlc_host_runTimer1();
+    tlc_host_runSPI();
+}
+
+/** Runs the Timer1 overflow interrupt if TOV1 is set, the interrupt is
+    enabled and interrupts are on.  TOV1 stays pending otherwise. */
+inline void tlc_host_runTimer1(void)
+{
+    TlcHostMcu &mcu = tlc_host();
+    if ((mcu.tifr1.value & _BV(TOV1)) && (mcu.timsk1.value & _BV(TOIE1))
+        && (mcu.sreg.value & _BV(SREG_I)) && TIMER1_OVF_vect) {
+        mcu.tifr1.value &= ~_BV(TOV1);
+        mcu.stats.interrupts++;
+        mcu.stats.cpuCycles += TLC_HOST_ISR_CYCLES;
+        mcu.stats.cycles += TLC_HOST_ISR_CYCLES;
+        mcu.sreg.value &= ~_BV(SREG_I);
+        TIMER1_OVF_vect();
+        mcu.sreg.value |= _BV(SREG_I);
+    }
+}
+
+/** Clears tlc_host().stats */
+inline void tlc_host_resetStats(void)
+{
+    TlcHostStats &stats = tlc_host().stats;
+    uint8_t *p = (uint8_t *)&stats;
+    for (uint16_t i = 0; i < sizeof(stats); i++) {
+        *p++ = 0;
+    }
+}
+
+/** The grayscale value the TLCs are currently displaying on a channel
+    (numbered like Tlc.set()). */
+inline uint16_t tlc_host_getGS(uint16_t channel)
+{
+    uint16_t tlc = channel / 16;
+    return tlc_host().chains[tlc / TLC_HOST_CHAIN_TLCS]
+            .tlcs[tlc % TLC_HOST_CHAIN_TLCS].gs[channel % 16];
+}
+
+/** The grayscale value the TLCs of tlc_host().extraChain are displaying on
+    a channel (0 to TLC_HOST_CHAIN_TLCS * 16 - 1) */
+inline uint16_t tlc_host_getExtraGS(uint16_t channel)
+{
+    return tlc_host().extraChain.tlcs[channel / 16].gs[channel % 16];
+}
+
+/** The dot correction value latched for a channel */
+inline uint8_t tlc_host_getDC(uint16_t channel)
+{
+    uint16_t tlc = channel / 16;
+    return tlc_host().chains[tlc / TLC_HOST_CHAIN_TLCS]
+            .tlcs[tlc % TLC_HOST_CHAIN_TLCS].dc[channel % 16];
+}
+
+/** millis() for the host build, set tlc_host().millis to move time */
+inline uint32_t millis(void)
+{
+    return tlc_host().millis;
+}
+
+/* -------------------------------- Pins ----------------------------------- */
+
+#define SREG     (tlc_host().sreg)
+#define PORTB    (tlc_host().portB)
+#define DDRB     (tlc_host().ddrB)
+#define PINB     (tlc_host().pinB)
+#define PORTC    (tlc_host().portC)
+#define DDRC     (tlc_host().ddrC)
+#define PINC     (tlc_host().pinC)
+#define PORTD    (tlc_host().portD)
+#define DDRD     (tlc_host().ddrD)
+#define PIND     (tlc_host().pinD)
+#define SPCR     (tlc_host().spcr)
+#define SPSR     (tlc_host().spsr)
+#define SPDR     (tlc_host().spdr)
+#define UCSR0A   (tlc_host().ucsr0a)
+#define UCSR0B   (tlc_host().ucsr0b)
+#define UCSR0C   (tlc_host().ucsr0c)
+#define UBRR0    (tlc_host().ubrr0)
+#define UDR0     (tlc_host().udr0)
+#define TCCR1A   (tlc_host().tccr1a)
+#define TCCR1B   (tlc_host().tccr1b)
+#define TIMSK1   (tlc_host().timsk1)
+#define TIFR1    (tlc_host().tifr1)
+#define OCR1A    (tlc_host().ocr1a)
+#define OCR1B    (tlc_host().ocr1b)
+#define ICR1     (tlc_host().icr1)
+#define TCNT1    (tlc_host().tcnt1)
+#define TCCR2A   (tlc_host().tccr2a)
+#define TCCR2B   (tlc_host().tccr2b)
+#define OCR2A    (tlc_host().ocr2a)
+#define OCR2B    (tlc_host().ocr2b)
+#define TCNT2    (tlc_host().tcnt2)
+
+/** VPRG (Arduino digital pin 8) -> VPRG (TLC pin 27) */
+#define DEFAULT_VPRG_PIN    PB0
+#define DEFAULT_VPRG_PORT   PORTB
+#define DEFAULT_VPRG_DDR    DDRB
+
+/** XERR (Arduino digital pin 12) -> XERR (TLC pin 16) */
+#define DEFAULT_XERR_PIN    PB4
+#define DEFAULT_XERR_PORT   PORTB
+#define DEFAULT_XERR_DDR    DDRB
+#define DEFAULT_XERR_PINS   PINB
+
+/** SIN (Arduino digital pin 7) -> SIN (TLC pin 26) */
+#define DEFAULT_BB_SIN_PIN      PD7
+#define DEFAULT_BB_SIN_PORT     PORTD
+#define DEFAULT_BB_SIN_DDR      DDRD
+/** SCLK (Arduino digital pin 4) -> SCLK (TLC pin 25) */
+#define DEFAULT_BB_SCLK_PIN     PD4
+#define DEFAULT_BB_SCLK_PORT    PORTD
+#define DEFAULT_BB_SCLK_DDR     DDRD
+
+/** SIN of the first chain (Arduino analog pin 0) for TLC_PARALLEL_BITBANG,
+    the next chains use analog pins 1 - 5 (up to 6 chains) */
+#define DEFAULT_PBB_SIN_FIRST_PIN   PC0
+#define DEFAULT_PBB_SIN_PORT        PORTC
+#define DEFAULT_PBB_SIN_DDR         DDRC
+/** The number of SIN pins from DEFAULT_PBB_SIN_FIRST_PIN up (PC6 is RESET) */
+#define DEFAULT_PBB_MAX_CHAINS      6
+
+/** SIN (Arduino digital pin 2) and SCLK (Arduino digital pin 5) of
+    tlc_host().extraChain, for a Tlc5940Chain in a test */
+#define TLC_HOST_EXTRA_SIN_PIN      PD2
+#define TLC_HOST_EXTRA_SCLK_PIN     PD5
+#define TLC_HOST_EXTRA_PORT         PORTD
+#define TLC_HOST_EXTRA_DDR          DDRD
+
+/** MOSI (Arduino digital pin 11) -> SIN (TLC pin 26) */
+#define TLC_MOSI_PIN     PB3
+#define TLC_MOSI_PORT    PORTB
+#define TLC_MOSI_DDR     DDRB
+
+/** SCK (Arduino digital pin 13) -> SCLK (TLC pin 25) */
+#define TLC_SCK_PIN      PB5
+#define TLC_SCK_PORT     PORTB
+#define TLC_SCK_DDR      DDRB
+
+/** XCK0 (Arduino digital pin 4) -> SCLK (TLC pin 25) for TLC_USART_SPI */
+#define TLC_XCK_PIN      PD4
+#define TLC_XCK_PORT     PORTD
+#define TLC_XCK_DDR      DDRD
+
+/** TXD0 (Arduino digital pin 1) -> SIN (TLC pin 26) for TLC_USART_SPI.
+    Serial can't be used at the same time. */
+#define TLC_TXD_PIN      PD1
+#define TLC_TXD_PORT     PORTD
+#define TLC_TXD_DDR      DDRD
+
+/** USART0 registers for TLC_USART_SPI */
+#define TLC_UDR          UDR0
+#define TLC_UCSRA        UCSR0A
+#define TLC_UCSRB        UCSR0B
+#define TLC_UCSRC        UCSR0C
+#define TLC_UBRR         UBRR0
+#define TLC_UDRE         UDRE0
+#define TLC_TXC          TXC0
+#define TLC_TXEN         TXEN0
+#define TLC_UMSEL1       UMSEL01
+#define TLC_UMSEL0       UMSEL00
+
+/** SS will be set to output as to not interfere with SPI master operation. */
+#define TLC_SS_PIN       PB2
+#define TLC_SS_DDR       DDRB
+
+/** OC1A (Arduino digital pin 9) -> XLAT (TLC pin 24) */
+#define XLAT_PIN     PB1
+#define XLAT_PORT    PORTB
+#define XLAT_DDR     DDRB
+
+/** OC1B (Arduino digital pin 10) -> BLANK (TLC pin 23) */
+#define BLANK_PIN    PB2
+#define BLANK_PORT   PORTB
+#define BLANK_DDR    DDRB
+
+/** OC2B (Arduino digital pin 3) -> GSCLK (TLC pin 18) */
+#define GSCLK_PIN    PD3
+#define GSCLK_PORT   PORTD
+#define GSCLK_DDR    DDRD
+
+/** Feeds pin changes to the TLC model.  SCLK edges are watched on both the
+    bit-bang SCLK pin (sampling the bit-bang SIN pin, unless the USART drives
+    it as XCK), the SPI SCK pin (sampling MOSI, unless the SPI is enabled
+    as master and drives SCK itself) and TLC_HOST_EXTRA_SCLK_PIN (sampling
+    TLC_HOST_EXTRA_SIN_PIN for tlc_host().extraChain). */
+inline void tlc_host_pinWritten(TlcHostRegister<uint8_t> &port,
+                                uint8_t oldValue)
+{
+    TlcHostMcu &mcu = tlc_host();
+    uint8_t rising = ~oldValue & port.value;
+    if (&port == &DEFAULT_BB_SCLK_PORT && (rising & _BV(DEFAULT_BB_SCLK_PIN))
+        && !mcu.usartSPI()) { // the USART drives XCK itself
+        mcu.stats.sclkPulses++;
+#if DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+        for (uint8_t c = 0; c < TLC_NUM_CHAINS; c++) {
+            mcu.chains[c].clock((DEFAULT_PBB_SIN_PORT.value
+                                 >> (DEFAULT_PBB_SIN_FIRST_PIN + c)) & 1);
+        }
+#else
+        mcu.chains[0].clock((DEFAULT_BB_SIN_PORT.value
+                             >> DEFAULT_BB_SIN_PIN) & 1);
+#endif
+    }
+    if (&port == &TLC_HOST_EXTRA_PORT
+        && (rising & _BV(TLC_HOST_EXTRA_SCLK_PIN))) {
+        mcu.stats.sclkPulses++;
+        mcu.extraChain.clock((TLC_HOST_EXTRA_PORT.value
+                              >> TLC_HOST_EXTRA_SIN_PIN) & 1);
+    }
+    if (&port == &TLC_SCK_PORT && (rising & _BV(TLC_SCK_PIN))
+        && !((mcu.spcr.value & _BV(SPE)) && (mcu.spcr.value & _BV(MSTR)))) {
+        mcu.stats.sclkPulses++;
+        mcu.chains[0].clock((TLC_MOSI_PORT.value >> TLC_MOSI_PIN) & 1);
+    }
+    if (&port == &XLAT_PORT && (rising & _BV(XLAT_PIN))) {
+        mcu.stats.xlatPulses++;
+        tlc_host_latch();
+    }
+    if (&port == &DEFAULT_VPRG_PORT
+        && ((oldValue ^ port.value) & _BV(DEFAULT_VPRG_PIN))) {
+        for (uint8_t c = 0; c < TLC_NUM_CHAINS; c++) {
+            mcu.chains[c].setVPRG((port.value >> DEFAULT_VPRG_PIN) & 1);
+        }
+    }
+}
+
+#endif
+
@@ -33,6 +33,16 @@
     #include <plib.h>       /* this gives the i/o definitions */
 #endif
 
+#ifndef PA0
+#define PA0     PORTA0
+#define PA1     PORTA1
+#define PA2     PORTA2
+#define PA3     PORTA3
+#define PA4     PORTA4
+#define PA5     PORTA5
+#define PA6     PORTA6
+#define PA7     PORTA7
+#endif
 #ifndef PB0
 #define PB0     PORTB0
 #define PB1     PORTB1
@@ -119,6 +129,11 @@
 /* Teensy++ 2.0 */
 #include "Teensypp_xxx6.h"
 
+#elif defined(TLC_HOST)
+
+/* Workstation build with the register mock */
+#include "Host.h"
+
 #elif defined(__PIC32MX__)
 
 /* ChipKit */
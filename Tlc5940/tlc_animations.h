@@ -20,31 +20,105 @@
 #define TLC_ANIMATIONS_H
 
 /** \file
-    TLC Animation functions.  These play animations from PROGMEM. */
+    TLC Animation functions.  These play animations from PROGMEM, either raw
+    (#NUM_TLCS * 24 bytes a frame) or compressed by
+    examples/CompressedAnimations/tlc_encode_animation.py. */
 
+#if defined(__AVR__)
 #include <avr/pgmspace.h>
 #include <avr/io.h>
+#endif
 
 #include "tlc_config.h"
 #include "Tlc5940.h"
 #include "tlc_progmem_utils.h"
 
+#if TLC_FAR_PROGMEM
+/** An animation's place in flash: a 32 bit address from
+    pgm_get_far_address() with #TLC_FAR_PROGMEM, a progmem pointer
+    without */
+#define TLC_ANIMATION_ADDRESS          uint_farptr_t
+#define tlc_animationAddress(p)        ((uint_farptr_t)(uintptr_t)(p))
+#define tlc_readAnimation(address)     pgm_read_byte_far(address)
+#define tlc_animationFrame(n) \
+        (tlc_currentAnimation + (uint32_t)(n) * (NUM_TLCS * 24))
+#define tlc_setGSfromAnimation(address) tlc_setGSfromFarProgmem(address)
+#else
+#define TLC_ANIMATION_ADDRESS          prog_uint8_t *
+#define tlc_animationAddress(p)        (p)
+#define tlc_readAnimation(address)     pgm_read_byte(address)
+#define tlc_animationFrame(n) \
+        (tlc_currentAnimation + (n) * NUM_TLCS * 24)
+#define tlc_setGSfromAnimation(address) tlc_setGSfromProgmem(address)
+#endif
+
 /** The currently playing animation */
-prog_uint8_t *tlc_currentAnimation;
+TLC_ANIMATION_ADDRESS tlc_currentAnimation;
 /** The number of frames in the current animation */
 volatile uint16_t tlc_animationFrames;
 /** The number of PWM periods to display each frame - 1 */
 volatile uint16_t tlc_animationPeriodsPerFrame;
 /** The current number of periods we've displayed this frame for */ 
 volatile uint16_t tlc_animationPeriodsWait;
+/** Non-zero if tlc_currentAnimation is compressed: it then points at the
+    next frame's ops instead of the start of the animation */
+volatile uint8_t tlc_animationCompressed;
+/** \name Compressed animations
+    A compressed animation starts with a 4 byte header, the number of frames
+    and the bytes in a frame (#NUM_TLCS * 24), both little endian.  The
+    frames follow in playing order, each a list of ops that covers its
+    #NUM_TLCS * 24 bytes of #tlc_GSData from the start.  An op byte is the op
+    in the top two bits and the run length - 1 (1 - 64 bytes) in the rest.  A
+    keyframe has no TLC_ANI_SKIP ops, so it doesn't depend on the frame
+    before it.  The first frame is always a keyframe. */
+/* @{ */
+/** The run length bytes follow */
+#define TLC_ANI_COPY          0x00
+/** The run of bytes is the same as in the last frame */
+#define TLC_ANI_SKIP          0x40
+/** The run repeats the #GS_DUO before it (each byte is the one 3 back), so
+    a run of channels with the same value is the first #GS_DUO and one op */
+#define TLC_ANI_REPEAT        0x80
+/** The run is all zero */
+#define TLC_ANI_ZERO          0xC0
+/** The run length - 1 bits of an op byte */
+#define TLC_ANI_LENGTH_MASK   0x3F
+/** Bytes before the first frame */
+#define TLC_ANI_HEADER_BYTES  4
+/* @} */
 
 volatile void tlc_animationXLATCallback(void);
 void tlc_playAnimation(prog_uint8_t *animation, uint16_t frames, uint16_t periodsPerFrame);
+uint8_t tlc_playCompressedAnimation(prog_uint8_t *animation,
+                                    uint16_t periodsPerFrame);
+#if TLC_FAR_PROGMEM
+void tlc_playFarAnimation(uint_farptr_t animation, uint16_t frames,
+                          uint16_t periodsPerFrame);
+uint8_t tlc_playCompressedFarAnimation(uint_farptr_t animation,
+                                       uint16_t periodsPerFrame);
+#endif
+static void tlc_startAnimation(TLC_ANIMATION_ADDRESS animation,
+                               uint16_t frames, uint16_t periodsPerFrame,
+                               uint8_t compressed);
+static uint8_t tlc_startCompressedAnimation(TLC_ANIMATION_ADDRESS animation,
+                                            uint16_t periodsPerFrame);
+static void tlc_decodeAnimationFrame(void);
 
 /** \addtogroup ExtendedFunctions
     \code #include "tlc_animations.h" \endcode
     - void tlc_playAnimation(prog_uint8_t *animation, uint16_t frames,
-            uint16_t periodsPerFrame) - plays an animation from progmem. */
+            uint16_t periodsPerFrame) - plays an animation from progmem.
+    - uint8_t tlc_playCompressedAnimation(prog_uint8_t *animation,
+            uint16_t periodsPerFrame) - plays a compressed animation from
+            progmem.
+    - void tlc_playFarAnimation(uint_farptr_t animation, uint16_t frames,
+            uint16_t periodsPerFrame) - tlc_playAnimation() anywhere in
+            flash (#TLC_FAR_PROGMEM).
+    - uint8_t tlc_playCompressedFarAnimation(uint_farptr_t animation,
+            uint16_t periodsPerFrame) - tlc_playCompressedAnimation()
+            anywhere in flash (#TLC_FAR_PROGMEM).
+
+    Interpolated animations are in tlc_interpolation.h. */
 /* @{ */
 
 /** Plays an animation from progmem in the "background" (with interrupts).
@@ -56,15 +130,136 @@ void tlc_playAnimation(prog_uint8_t *animation, uint16_t frames, uint16_t period
            (0 means play the animation as fast as possible).
            The default PWM period for a 16MHz clock is 1.024ms. */
 void tlc_playAnimation(prog_uint8_t *animation, uint16_t frames, uint16_t periodsPerFrame)
+{
+    tlc_startAnimation(tlc_animationAddress(animation), frames,
+                       periodsPerFrame, 0);
+}
+
+/** Plays an animation made by tlc_encode_animation.py, like
+    tlc_playAnimation().  The encoder keeps runs of zeros, of channels with
+    the same value and of bytes that didn't change since the last frame as
+    one byte ops, so mostly dark or slow animations take a fraction of the
+    flash.  Each frame is decoded straight into #tlc_GSData from the XLAT
+    interrupt: at most 2 * #NUM_TLCS * 24 progmem reads and #NUM_TLCS * 24
+    writes, about what tlc_setGSfromProgmem() costs for a raw frame.
+    \param animation A progmem array from tlc_encode_animation.py.  Ensure
+           that there is not an update waiting to happen before calling this.
+    \param periodsPerFrame number of PWM periods to wait between each frame
+           (0 means play the animation as fast as possible).
+    \returns 1 if the animation started, 0 if it was encoded for a different
+             #NUM_TLCS */
+uint8_t tlc_playCompressedAnimation(prog_uint8_t *animation,
+                                    uint16_t periodsPerFrame)
+{
+    return tlc_startCompressedAnimation(tlc_animationAddress(animation),
+                                        periodsPerFrame);
+}
+
+#if TLC_FAR_PROGMEM
+
+/** tlc_playAnimation() for an animation anywhere in flash.  On the
+    ATmega1280/2560 PROGMEM arrays past the first 64 KB can't be reached
+    with a progmem pointer:
+    \code
+tlc_playFarAnimation(pgm_get_far_address(ani_show), ANI_SHOW_FRAMES, 3);
+    \endcode
+    Each frame is copied with tlc_setGSfromFarProgmem(), as fast as the near
+    copy.  (avr-gcc arrays are at most 32 KB, split longer shows into several
+    animations.)
+    \param animation the flash address of the animation
+    \param frames the number of frames in animation
+    \param periodsPerFrame number of PWM periods to wait between each
+           frame */
+void tlc_playFarAnimation(uint_farptr_t animation, uint16_t frames,
+                          uint16_t periodsPerFrame)
+{
+    tlc_startAnimation(animation, frames, periodsPerFrame, 0);
+}
+
+/** tlc_playCompressedAnimation() for an animation anywhere in flash.
+    \param animation the flash address (pgm_get_far_address()) of an array
+           from tlc_encode_animation.py
+    \param periodsPerFrame number of PWM periods to wait between each frame
+    \returns 1 if the animation started, 0 if it was encoded for a different
+             #NUM_TLCS */
+uint8_t tlc_playCompressedFarAnimation(uint_farptr_t animation,
+                                       uint16_t periodsPerFrame)
+{
+    return tlc_startCompressedAnimation(animation, periodsPerFrame);
+}
+
+#endif
+
+/** Starts playing an animation from the XLAT interrupt. */
+static void tlc_startAnimation(TLC_ANIMATION_ADDRESS animation,
+                               uint16_t frames, uint16_t periodsPerFrame,
+                               uint8_t compressed)
 {
     tlc_currentAnimation = animation;
     tlc_animationFrames = frames;
     tlc_animationPeriodsPerFrame = periodsPerFrame;
     tlc_animationPeriodsWait = 0;
+    tlc_animationCompressed = compressed;
     tlc_onUpdateFinished = tlc_animationXLATCallback;
     tlc_animationXLATCallback();
 }
 
+/** Checks the header of a compressed animation and starts it. */
+static uint8_t tlc_startCompressedAnimation(TLC_ANIMATION_ADDRESS animation,
+                                            uint16_t periodsPerFrame)
+{
+    if (tlc_readAnimation(animation + 2) != (uint8_t)(NUM_TLCS * 24)
+            || tlc_readAnimation(animation + 3)
+               != (uint8_t)((NUM_TLCS * 24) >> 8)) {
+        return 0;
+    }
+    uint16_t frames = tlc_readAnimation(animation)
+                      | (tlc_readAnimation(animation + 1) << 8);
+    tlc_startAnimation(animation + TLC_ANI_HEADER_BYTES, frames,
+                       periodsPerFrame, 1);
+    return 1;
+}
+
+/** Decodes the frame at tlc_currentAnimation into #tlc_GSData and moves
+    tlc_currentAnimation to the next one. */
+static void tlc_decodeAnimationFrame(void)
+{
+    TLC_ANIMATION_ADDRESS p = tlc_currentAnimation;
+    uint8_t *gsDatap = tlc_GSData;
+    while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+        uint8_t op = tlc_readAnimation(p++);
+        uint8_t length = (op & TLC_ANI_LENGTH_MASK) + 1;
+        switch (op & ~TLC_ANI_LENGTH_MASK) {
+            case TLC_ANI_COPY:
+#if TLC_FAR_PROGMEM
+                tlc_copyFromFarProgmem(gsDatap, p, length);
+                gsDatap += length;
+                p += length;
+#else
+                do {
+                    *gsDatap++ = pgm_read_byte(p++);
+                } while (--length);
+#endif
+                break;
+            case TLC_ANI_SKIP:
+                gsDatap += length;
+                break;
+            case TLC_ANI_REPEAT:
+                do {
+                    *gsDatap = *(gsDatap - 3);
+                    gsDatap++;
+                } while (--length);
+                break;
+            default: // TLC_ANI_ZERO
+                do {
+                    *gsDatap++ = 0;
+                } while (--length);
+        }
+    }
+    tlc_currentAnimation = p;
+    tlc_markGSDirty();
+}
+
 /** This is called by the XLAT interrupt every PWM period to do stuff. */
 volatile void tlc_animationXLATCallback(void)
 {
@@ -73,10 +268,15 @@ volatile void tlc_animationXLATCallback(void)
         set_XLAT_interrupt();
     } else {
         if (tlc_animationFrames) {
-            tlc_setGSfromProgmem(tlc_currentAnimation +
-                                (--tlc_animationFrames * NUM_TLCS * 24));
+            if (tlc_animationCompressed) {
+                tlc_animationFrames--;
+                tlc_decodeAnimationFrame();
+            } else {
+                tlc_setGSfromAnimation(
+                        tlc_animationFrame(--tlc_animationFrames));
+            }
             tlc_animationPeriodsWait = tlc_animationPeriodsPerFrame;
-            Tlc.update();
+            tlc_present();
         } else { // animation is done
             tlc_onUpdateFinished = 0;
         }
@@ -0,0 +1,226 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_CHAIN_H
+#define TLC_CHAIN_H
+
+/** \file
+    Extra bit-banged daisy-chains with their size and pins set in the
+    sketch.  This is an add-on next to Tlc, not another way to build Tlc:
+    Tlc keeps the hardware SPI, the other transfer modes, dot correction and
+    the tlc_config.h options (#TLC_DOUBLE_BUFFER, #TLC_ASYNC_UPDATE), a chain
+    only has the grayscale data and a bit-banged update().  The channel
+    packing is shared with Tlc (tlc_setPacked()). */
+
+#include "tlc_config.h"
+#include "Tlc5940.h"
+
+/** \addtogroup ExtendedFunctions
+    \code #include "tlc_chain.h" \endcode
+    - Tlc5940Chain<NumTlcs, Transfer> - another daisy-chain of NumTlcs TLCs,
+      sized at compile time and driven next to Tlc.
+    - TLC_CHAIN_PIN(name, port, ddr, pin) - names a pin for a Transfer. */
+/* @{ */
+
+/** Declares a pin for a chain's Transfer, like
+    \code TLC_CHAIN_PIN(Sin2, PORTD, DDRD, PD2); \endcode
+    The functions compile to single sbi/cbi instructions. */
+#define TLC_CHAIN_PIN(name, port, ddr, pin) \
+    struct name { \
+        static void output(void) { ddr |= _BV(pin); } \
+        static void high(void)   { port |= _BV(pin); } \
+        static void low(void)    { port &= ~_BV(pin); } \
+    }
+
+/** The smallest type that holds a channel of a chain: uint8_t up to 16
+    TLCs, uint16_t above (see #TLC_CHANNEL_TYPE). */
+template <bool Wide> struct TlcChainChannel      { typedef uint8_t type; };
+template <>          struct TlcChainChannel<true> { typedef uint16_t type; };
+
+/** Bit-bangs a chain on its own SIN and SCLK pins (both declared with
+    TLC_CHAIN_PIN).  Chains can share a SIN pin, but not SCLK: every pulse
+    shifts every TLC on that SCLK, including the ones of Tlc. */
+template <class SinPin, class SclkPin>
+struct TlcBitBang
+{
+    /** Sets SIN and SCLK to output */
+    static void init(void)
+    {
+        SinPin::output();
+        SclkPin::output();
+        SclkPin::low();
+    }
+
+    /** One SCLK pulse */
+    static void pulseClock(void)
+    {
+        SclkPin::high();
+        SclkPin::low();
+    }
+
+    /** Shifts a byte out, MSB first */
+    static void shift8(uint8_t byte)
+    {
+        for (uint8_t bit = 0x80; bit; bit >>= 1) {
+            if (bit & byte) {
+                SinPin::high();
+            } else {
+                SinPin::low();
+            }
+            pulseClock();
+        }
+    }
+};
+
+/** A daisy-chain of NumTlcs TLCs with its own grayscale data.  The buffer
+    size, the channel type and the index math of set() and get() all come
+    from the template arguments, so a set() with a constant channel is
+    folded down to the two byte writes, and chains of different sizes can
+    be in one sketch without touching tlc_config.h.
+
+    Every chain shares GSCLK, BLANK and XLAT with Tlc, so they all latch on
+    the same XLAT pulse: a chain's update() waits on #tlc_needXLAT like
+    Tlc.update() and sets it for the one XLAT pulse, whoever shifted last.
+    The chain's VPRG has to be tied to GND (there's no dot correction for a
+    chain), so its TLCs never have the first grayscale cycle after dot
+    correction and update() always sends the extra SCLK pulse.  The
+    Transfer decides how the bytes get to the chain (TlcBitBang is the only
+    one, the hardware SPI belongs to Tlc).  An example:
+    \code
+#include "tlc_chain.h"
+
+TLC_CHAIN_PIN(Sin2, PORTD, DDRD, PD2);   // Arduino digital pin 2
+TLC_CHAIN_PIN(Sclk2, PORTD, DDRD, PD5);  // Arduino digital pin 5
+Tlc5940Chain<3, TlcBitBang<Sin2, Sclk2> > panel;
+
+// sometime after Tlc.init()
+panel.init();
+panel.set(47, 4095);
+while (panel.update());
+    \endcode
+    \note XLAT latches whatever is in the shift registers of Tlc's TLCs, so
+          call Tlc.update() after Tlc.setAllDC() or tlc_setDCfromProgmem()
+          before updating a chain. */
+template <uint8_t NumTlcs, class Transfer>
+class Tlc5940Chain
+{
+  public:
+    /** Channel number type for this chain */
+    typedef typename TlcChainChannel<(NumTlcs > 16)>::type Channel;
+
+    enum {
+        numTlcs = NumTlcs,       /**< TLCs in this chain */
+        numChannels = NumTlcs * 16, /**< channels in this chain */
+        numBytes = NumTlcs * 24  /**< bytes of grayscale data */
+    };
+
+    /** Packed grayscale data in the format of #tlc_GSData */
+    uint8_t gsData[NumTlcs * 24];
+
+    /** Sets up the pins, sets every channel to initialValue and shifts it
+        in for the next XLAT.  Call this after Tlc.init().  It doesn't wait
+        for the XLAT, an update of Tlc (or another chain) can still be
+        waiting for it; then call update() until it returns 0.
+        \returns 1 if initialValue still needs an update(), 0 if it was
+                 shifted in */
+    uint8_t init(uint16_t initialValue = 0)
+    {
+        Transfer::init();
+        setAll(initialValue);
+        return update();
+    }
+
+    /** Sets all channels to 0.  Needs an update(). */
+    void clear(void)
+    {
+        setAll(0);
+    }
+
+    /** Shifts in gsData and asks for an XLAT, see Tlc5940::update.
+        \returns 1 if there is data waiting to be latched (nothing was
+                 shifted), 0 if data was shifted in */
+    uint8_t update(void)
+    {
+        if (tlc_needXLAT) {
+            return 1;
+        }
+#if TLC_DIRTY_TRACKING
+        if (!dirty) {
+            skippedUpdates++;
+            return 0;
+        }
+        dirty = 0;
+#endif
+        disable_XLAT_pulses();
+        Transfer::pulseClock(); // the extra SCLK pulse (VPRG is always low)
+        tlc_needXLAT = 1;
+        uint8_t *p = gsData;
+        while (p < gsData + NumTlcs * 24) {
+            Transfer::shift8(*p++);
+            Transfer::shift8(*p++);
+            Transfer::shift8(*p++);
+        }
+        enable_XLAT_pulses();
+        set_XLAT_interrupt();
+        return 0;
+    }
+
+    /** Sets a channel, see Tlc5940::set.
+        \param channel (0 to NumTlcs * 16 - 1)
+        \param value (0-4095) */
+    void set(Channel channel, uint16_t value)
+    {
+        Channel index8 = (NumTlcs * 16 - 1) - channel;
+#if TLC_DIRTY_TRACKING
+        dirty |= tlc_setPacked(gsData, index8, value);
+#else
+        tlc_setPacked(gsData, index8, value);
+#endif
+    }
+
+    /** Gets a channel, see Tlc5940::get.
+        \param channel (0 to NumTlcs * 16 - 1)
+        \returns grayscale value (0 - 4095) */
+    uint16_t get(Channel channel) const
+    {
+        Channel index8 = (NumTlcs * 16 - 1) - channel;
+        return tlc_getPacked(gsData, index8);
+    }
+
+    /** Sets all channels to value (0 - 4095) */
+    void setAll(uint16_t value)
+    {
+        tlc_setAllPacked(gsData, gsData + NumTlcs * 24, value);
+#if TLC_DIRTY_TRACKING
+        dirty = 1;
+#endif
+    }
+
+#if TLC_DIRTY_TRACKING
+    /** True (!= 0) if gsData changed since the last update() */
+    uint8_t dirty;
+    /** update() calls skipped because nothing changed, like
+        #tlc_skippedUpdates for Tlc */
+    uint32_t skippedUpdates;
+#endif
+};
+
+/* @} */
+
+#endif
+
@@ -31,8 +31,17 @@
     - Enable/Disable XERR functionality: XERR_ENABLED (default 0)
     - Should the library use bit-banging (any pins) or hardware SPI (faster):
         DATA_TRANSFER_MODE (default TLC_SPI)
+    - Number of daisy-chains bit-banged at once (TLC_PARALLEL_BITBANG):
+        TLC_NUM_CHAINS (default 1)
+    - Should Tlc.update() shift the data out from the SPI interrupt:
+        TLC_ASYNC_UPDATE (default 0)
+    - Use a front/back pair of grayscale buffers: TLC_DOUBLE_BUFFER (default 0)
+    - Skip updates when the grayscale data hasn't changed: TLC_DIRTY_TRACKING
+        (default 0)
     - Which pins to use for bit-banging: SIN_PIN, SIN_PORT, SIN_DDR and
         SCLK_PIN, SCLK_PORT, SCLK_DDR
+    - Which pins to use for parallel bit-banging: PARALLEL_SIN_FIRST_PIN,
+        PARALLEL_SIN_PORT, PARALLEL_SIN_DDR
     - The PWM period: TLC_PWM_PERIOD (be sure to change TLC_GSCLK_PERIOD
         accordingly!)
 
@@ -45,6 +54,11 @@
 #define TLC_BITBANG        1
 /** Use the much faster hardware SPI module */
 #define TLC_SPI            2
+/** Bit-bang several daisy-chains at once, each with its own SIN pin on the
+    same port */
+#define TLC_PARALLEL_BITBANG    3
+/** Use the USART in master SPI mode (buffered, no gaps between bytes) */
+#define TLC_USART_SPI      4
 
 /* ------------------------ START EDITING HERE ----------------------------- */
 
@@ -52,13 +66,93 @@
     of the first TLC to the SIN (TLC pin 26) of the next.  The rest of the pins
     are attached normally.
     \note Each TLC needs it's own IREF resistor */
+#ifndef NUM_TLCS
 #define NUM_TLCS    1
+#endif
 
 /** Determines how data should be transfered to the TLCs.  Bit-banging can use
     any two i/o pins, but the hardware SPI is faster.
     - Bit-Bang = TLC_BITBANG
-    - Hardware SPI = TLC_SPI (default) */
+    - Hardware SPI = TLC_SPI (default)
+    - Bit-Bang TLC_NUM_CHAINS daisy-chains at once = TLC_PARALLEL_BITBANG
+    - USART in master SPI mode = TLC_USART_SPI (ATmega xx8 and xx4 only).  The
+      transmit buffer lets the next byte go out right after the last one, and
+      the hardware SPI is left free for other devices.  Uses the TX pin, so
+      Serial can't be used. */
+#ifndef DATA_TRANSFER_MODE
 #define DATA_TRANSFER_MODE    TLC_SPI
+#endif
+
+/** Number of separate daisy-chains for TLC_PARALLEL_BITBANG (1 - 6 on the
+    ATmega xx8 and ATmega8, 1 - 8 on the Mega and Sanguino, see
+    DEFAULT_PBB_MAX_CHAINS in the pinouts).  The chains share SCLK, XLAT,
+    BLANK, GSCLK (and VPRG), and each chain has its own SIN pin, so one port
+    write clocks a bit into every chain.  NUM_TLCS is the total: each chain
+    has NUM_TLCS / TLC_NUM_CHAINS TLCs and its channels follow the channels
+    of the previous chain.
+    \note The other transfer modes only have one chain. */
+#ifndef TLC_NUM_CHAINS
+#define TLC_NUM_CHAINS    1
+#endif
+
+/** Enables/disables interrupt-driven grayscale updates (requires TLC_SPI).
+    - 0 Tlc.update() waits for every byte to be shifted out (default)
+    - 1 Tlc.update() loads the first byte and returns right away.  The SPI
+        Serial Transfer Complete interrupt shifts out the rest of
+        #tlc_GSData and arms the XLAT pulse after the last byte.
+    \note Don't change #tlc_GSData until #tlc_needXLAT is cleared (or the
+          next #tlc_onUpdateFinished call), otherwise the frame will tear. */
+#ifndef TLC_ASYNC_UPDATE
+#define TLC_ASYNC_UPDATE    0
+#endif
+
+/** Enables/disables a second grayscale buffer (uses another NUM_TLCS * 24
+    bytes of ram).
+    - 0 Tlc.set() writes the data that Tlc.update() shifts out (default)
+    - 1 Tlc.set() writes a back buffer (#tlc_GSData).  Tlc.commit() swaps it
+        with the front buffer, which is shifted out right away or, if a latch
+        is still pending, by the XLAT interrupt.  Sketches never have to wait
+        on #tlc_needXLAT and frames can't tear. */
+#ifndef TLC_DOUBLE_BUFFER
+#define TLC_DOUBLE_BUFFER    0
+#endif
+
+/** Enables/disables skipping updates when nothing has changed.
+    - 0 every Tlc.update() shifts out all NUM_TLCS * 24 bytes (default)
+    - 1 Tlc.set() and Tlc.setAll() set #tlc_GSDirty when they change
+        #tlc_GSData.  Tlc.update() (or Tlc.commit() with #TLC_DOUBLE_BUFFER)
+        doesn't shift anything or pulse XLAT while it's clear and counts the
+        call in #tlc_skippedUpdates instead.
+    \note The TLCs can only load the whole chain, so one changed channel still
+          shifts out everything.  Code that writes #tlc_GSData directly has to
+          call tlc_markGSDirty(). */
+#ifndef TLC_DIRTY_TRACKING
+#define TLC_DIRTY_TRACKING    0
+#endif
+
+/** Enables/disables counting PWM periods.
+    - 0 the Timer1 overflow interrupt only runs after an update (default)
+    - 1 the Timer1 overflow interrupt runs every PWM period (TLC_PWM_PERIOD
+        * 2 clocks, 1.024ms by default) and increments #tlc_pwmTicks.  This
+        is a clock that keeps going with Timer0 (millis()) turned off, see
+        #TLC_FADE_TICKS in tlc_fades.h.
+    \note This costs an interrupt every PWM period, about 30 cycles when
+          there's no XLAT to handle. */
+#ifndef TLC_PWM_TICKS
+#define TLC_PWM_TICKS    0
+#endif
+
+/** Enables/disables animations above the first 64 KB of flash (ATmega1280
+    and 2560).
+    - 0 animations are near progmem pointers (default)
+    - 1 the animation in tlc_animations.h is a 32 bit flash address read
+        with ELPM, so it can be anywhere in flash.  Adds
+        tlc_playFarAnimation(), tlc_playCompressedFarAnimation() and
+        tlc_setGSfromFarProgmem(); get the address of a PROGMEM array with
+        pgm_get_far_address(). */
+#ifndef TLC_FAR_PROGMEM
+#define TLC_FAR_PROGMEM    0
+#endif
 
 /* This include is down here because the files it includes needs the data
    transfer mode */
@@ -79,10 +173,27 @@
 #define SCLK_DDR       DEFAULT_BB_SCLK_DDR
 #endif
 
+#if DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+/** SIN (TLC pin 26) of the first chain.  The SIN of chain n is pin
+    PARALLEL_SIN_FIRST_PIN + n of the same port. */
+#define PARALLEL_SIN_FIRST_PIN    DEFAULT_PBB_SIN_FIRST_PIN
+#define PARALLEL_SIN_PORT         DEFAULT_PBB_SIN_PORT
+#define PARALLEL_SIN_DDR          DEFAULT_PBB_SIN_DDR
+/** The most chains PARALLEL_SIN_PORT has SIN pins for, counting up from
+    PARALLEL_SIN_FIRST_PIN */
+#define PARALLEL_SIN_MAX_CHAINS   DEFAULT_PBB_MAX_CHAINS
+/** SCLK (TLC pin 25) of every chain */
+#define SCLK_PIN       DEFAULT_BB_SCLK_PIN
+#define SCLK_PORT      DEFAULT_BB_SCLK_PORT
+#define SCLK_DDR       DEFAULT_BB_SCLK_DDR
+#endif
+
 
 /** If more than 16 TLCs are daisy-chained, the channel type has to be uint16_t.
     Default is uint8_t, which supports up to 16 TLCs. */
+#ifndef TLC_CHANNEL_TYPE
 #define TLC_CHANNEL_TYPE    uint8_t
+#endif
 
 /** Determines how long each PWM period should be, in clocks.
     \f$\displaystyle f_{PWM} = \frac{f_{osc}}{2 * TLC\_PWM\_PERIOD} Hz \f$
@@ -91,14 +202,18 @@
     \f$\displaystyle TLC\_PWM\_PERIOD =
        \frac{(TLC\_GSCLK\_PERIOD + 1) * 4096}{2} \f$
     \note The default of 8192 means the PWM frequency is 976.5625Hz */
+#ifndef TLC_PWM_PERIOD
 #define TLC_PWM_PERIOD    8192
+#endif
 
 /** Determines how long each period GSCLK is.
     This is related to TLC_PWM_PERIOD:
     \f$\displaystyle TLC\_GSCLK\_PERIOD =
        \frac{2 * TLC\_PWM\_PERIOD}{4096} - 1 \f$
     \note Default is 3 */
+#ifndef TLC_GSCLK_PERIOD
 #define TLC_GSCLK_PERIOD    3
+#endif
 
 /** Enables/disables VPRG (TLC pin 27) functionality.  If you need to set dot
     correction data, this needs to be enabled.
@@ -106,14 +221,18 @@
     - 1 VPRG is connected
     \note VPRG to GND inputs grayscale data, VPRG to Vcc inputs dot-correction
           data */
+#ifndef VPRG_ENABLED
 #define VPRG_ENABLED    0
+#endif
 
 /** Enables/disables XERR (TLC pin 16) functionality to check for shorted/broken
     LEDs
     - 0 XERR is not connected (default)
     - 1 XERR is connected
     \note XERR is active low */
+#ifndef XERR_ENABLED
 #define XERR_ENABLED    0
+#endif
 
 /*  You can change the VPRG and XERR pins freely.  The defaults are defined in
     the chip-specific pinouts:  see pinouts/ATmega_xx8.h for most Arduino's. */
@@ -146,13 +265,60 @@
 #define SCLK_DDR       TLC_SCK_DDR
 #endif
 
+#if DATA_TRANSFER_MODE == TLC_USART_SPI
+/** SIN (TLC pin 26) */
+#define SIN_PIN        TLC_TXD_PIN
+#define SIN_PORT       TLC_TXD_PORT
+#define SIN_DDR        TLC_TXD_DDR
+/** SCLK (TLC pin 25) */
+#define SCLK_PIN       TLC_XCK_PIN
+#define SCLK_PORT      TLC_XCK_PORT
+#define SCLK_DDR       TLC_XCK_DDR
+#endif
+
 
 
 #if !(DATA_TRANSFER_MODE == TLC_BITBANG \
- || DATA_TRANSFER_MODE == TLC_SPI)
+ || DATA_TRANSFER_MODE == TLC_SPI \
+ || DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG \
+ || DATA_TRANSFER_MODE == TLC_USART_SPI)
 #error "Invalid DATA_TRANSFER_MODE specified, see DATA_TRANSFER_MODE"
 #endif
 
+#if DATA_TRANSFER_MODE == TLC_USART_SPI && !defined(TLC_UDR)
+#error "This chip doesn't have a USART that can run as an SPI master"
+#endif
+
+#if TLC_NUM_CHAINS != 1 && DATA_TRANSFER_MODE != TLC_PARALLEL_BITBANG
+#error "TLC_NUM_CHAINS requires DATA_TRANSFER_MODE to be TLC_PARALLEL_BITBANG"
+#endif
+
+#if TLC_NUM_CHAINS < 1 || TLC_NUM_CHAINS > 8
+#error "TLC_NUM_CHAINS has to be 1 - 8"
+#endif
+
+#if NUM_TLCS % TLC_NUM_CHAINS
+#error "NUM_TLCS has to be a multiple of TLC_NUM_CHAINS"
+#endif
+
+#if DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG \
+ && (PARALLEL_SIN_FIRST_PIN + TLC_NUM_CHAINS > 8 \
+  || TLC_NUM_CHAINS > PARALLEL_SIN_MAX_CHAINS)
+#error "The SIN pins of TLC_NUM_CHAINS chains don't fit on PARALLEL_SIN_PORT"
+#endif
+
+/** The number of TLCs in each daisy-chain */
+#define TLC_CHAIN_TLCS    (NUM_TLCS / TLC_NUM_CHAINS)
+
+#if TLC_ASYNC_UPDATE && DATA_TRANSFER_MODE != TLC_SPI
+#error "TLC_ASYNC_UPDATE requires DATA_TRANSFER_MODE to be TLC_SPI"
+#endif
+
+#if defined(__PIC32MX__) \
+ && (TLC_ASYNC_UPDATE || TLC_DOUBLE_BUFFER || TLC_PWM_TICKS)
+#error "TLC_ASYNC_UPDATE, TLC_DOUBLE_BUFFER and TLC_PWM_TICKS need an AVR"
+#endif
+
 /* Various Macros */
 
 /** Arranges 2 grayscale values (0 - 4095) in the packed array format (3 bytes).
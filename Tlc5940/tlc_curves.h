@@ -0,0 +1,131 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_CURVES_H
+#define TLC_CURVES_H
+
+/** \file
+    Easing and gamma curves in PROGMEM, used by the fades in tlc_fades.h. */
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+
+#include "tlc_config.h"
+#include "Tlc5940.h"
+
+/** A straight line (no table) */
+#define TLC_CURVE_LINEAR         0
+/** Starts slow, ends fast (t^2) */
+#define TLC_CURVE_EASE_IN        1
+/** Starts fast, ends slow (1 - (1 - t)^2) */
+#define TLC_CURVE_EASE_OUT       2
+/** Starts and ends slow (3t^2 - 2t^3) */
+#define TLC_CURVE_EASE_IN_OUT    3
+/** Looks linear to the eye (t^2.2) */
+#define TLC_CURVE_GAMMA          4
+/** The first curve for tlc_setCurve() */
+#define TLC_CURVE_USER           5
+
+#ifndef TLC_NUM_USER_CURVES
+/** How many curves a sketch can add with tlc_setCurve() (2 bytes of ram
+    each) */
+#define TLC_NUM_USER_CURVES      2
+#endif
+
+/** Number of points in a curve table: 32 segments, interpolated */
+#define TLC_CURVE_POINTS         33
+
+/** A curve table: TLC_CURVE_POINTS values (0 - 4095) at t = 0, 1/32, ... 1 */
+#define TLC_CURVE(name)          prog_uint16_t name[TLC_CURVE_POINTS] PROGMEM
+
+TLC_CURVE(tlc_curveEaseIn) = {
+    0, 4, 16, 36, 64, 100, 144, 196, 256, 324, 400, 484, 576, 676, 784, 900,
+    1024, 1156, 1296, 1444, 1600, 1764, 1936, 2115, 2303, 2499, 2703, 2915,
+    3135, 3363, 3599, 3843, 4095
+};
+TLC_CURVE(tlc_curveEaseOut) = {
+    0, 252, 496, 732, 960, 1180, 1392, 1596, 1792, 1980, 2159, 2331, 2495,
+    2651, 2799, 2939, 3071, 3195, 3311, 3419, 3519, 3611, 3695, 3771, 3839,
+    3899, 3951, 3995, 4031, 4059, 4079, 4091, 4095
+};
+TLC_CURVE(tlc_curveEaseInOut) = {
+    0, 12, 46, 101, 176, 269, 378, 502, 640, 790, 950, 1119, 1296, 1478, 1666,
+    1856, 2048, 2239, 2429, 2617, 2799, 2976, 3145, 3305, 3455, 3593, 3717,
+    3826, 3919, 3994, 4049, 4083, 4095
+};
+TLC_CURVE(tlc_curveGamma) = {
+    0, 2, 9, 22, 42, 69, 103, 145, 194, 251, 317, 391, 473, 564, 664, 773,
+    891, 1018, 1155, 1301, 1456, 1621, 1796, 1980, 2175, 2379, 2593, 2818,
+    3053, 3298, 3553, 3819, 4095
+};
+
+/** The curve tables, TLC_CURVE_EASE_IN is tlc_curveTables[0] */
+prog_uint16_t *tlc_curveTables[TLC_CURVE_USER - 1 + TLC_NUM_USER_CURVES] = {
+    tlc_curveEaseIn, tlc_curveEaseOut, tlc_curveEaseInOut, tlc_curveGamma
+};
+
+uint16_t tlc_curve(uint8_t curve, uint16_t t);
+void tlc_setCurve(uint8_t curve, prog_uint16_t *table);
+
+/** \addtogroup ExtendedFunctions
+    \code #include "tlc_curves.h" \endcode
+    - uint16_t tlc_curve(uint8_t curve, uint16_t t) - looks up t (0 - 4095)
+      on a curve
+    - void tlc_setCurve(uint8_t curve, prog_uint16_t *table) - sets a user
+      curve (TLC_CURVE_USER, TLC_CURVE_USER + 1, ...) */
+/* @{ */
+
+/** Looks up t on a curve, interpolating between the two nearest points of
+    its table.  No floating point or division.
+    \param curve TLC_CURVE_LINEAR, TLC_CURVE_EASE_IN, ...
+    \param t (0 - 4095) how far along the curve
+    \returns (0 - 4095) */
+uint16_t tlc_curve(uint8_t curve, uint16_t t)
+{
+    if (curve == TLC_CURVE_LINEAR) {
+        return t;
+    }
+    prog_uint16_t *p = tlc_curveTables[curve - 1] + (t >> 7);
+    uint16_t a = pgm_read_word(p);
+    uint16_t b = pgm_read_word(p + 1);
+    uint8_t fraction = t & 127; // 128 steps between points
+    return a + (int16_t)(((int32_t)(b - a) * fraction) >> 7);
+}
+
+/** Sets a user curve.  An example:
+    \code
+#include "tlc_fades.h"
+TLC_CURVE(bounce) = { 0, ... }; // TLC_CURVE_POINTS values, 0 - 4095
+
+// in setup()
+tlc_setCurve(TLC_CURVE_USER, bounce);
+tlc_addFade(0, 0, 4095, millis(), millis() + 1000, TLC_CURVE_USER);
+    \endcode
+    \param curve TLC_CURVE_USER to TLC_CURVE_USER + #TLC_NUM_USER_CURVES - 1
+    \param table TLC_CURVE_POINTS values (0 - 4095) in progmem.  The first
+           should be 0 and the last 4095 so fades don't jump at the ends. */
+void tlc_setCurve(uint8_t curve, prog_uint16_t *table)
+{
+    tlc_curveTables[curve - 1] = table;
+}
+
+/* @} */
+
+#endif
+
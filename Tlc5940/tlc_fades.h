@@ -22,189 +22,1015 @@
 /** \file
     TLC fading functions. */
 
+#if defined(__AVR__)
 #include <avr/interrupt.h>
+#endif
 
 #include "Tlc5940.h"
+#include "tlc_curves.h"
 
-#if defined(ARDUINO) && ARDUINO >= 100
+#if defined(TLC_HOST)
+/* millis() is in pinouts/Host.h */
+#elif defined(ARDUINO) && ARDUINO >= 100
 #include "Arduino.h"
 #else
 #include "WProgram.h"
 #endif
 
+#ifndef TLC_FADE_COMPACT
+/** The layout of struct Tlc_FadeState.
+    - 0 26 bytes a fade: 32 bit times and a 16.16 fixed point value that's
+        stepped with an add, so a step doesn't divide and a fade can last
+        as long as tlc_fadeTime() doesn't wrap (default).
+    - 1 13 bytes a fade (14 if #NUM_TLCS > 16), as small as a fade was
+        before the pool: 16 bit times relative to #tlc_fadeEpoch and 12 bit
+        values, so twice as many fades fit in the same ram.  Each step
+        divides to find how far along a fade is (a 32 by 16 bit divide per
+        fade), and a fade can last at most 65535 ticks of tlc_fadeTime().
+        All the fades in the pool have to end within 65535 ticks of each
+        other, tlc_addFade() returns 0 for one that doesn't. */
+#define TLC_FADE_COMPACT    0
+#endif
+
 #ifndef TLC_FADE_BUFFER_LENGTH
-/** The default fade buffer length (24).  Uses 24*13 = 312 bytes of ram. */
+#if TLC_FADE_COMPACT
+/** The length of the default fade pool, #tlc_fadeBuffer (24).  Uses 24*13 =
+    312 bytes of ram, plus #NUM_TLCS * 16 bytes for #tlc_channelFades.  Set
+    it to 0 if the sketch always gives tlc_initFadePool() its own arena. */
 #define TLC_FADE_BUFFER_LENGTH    24
+#else
+/** The length of the default fade pool, #tlc_fadeBuffer (12).  Uses 12*26 =
+    312 bytes of ram, as much as the 24 fades of the old buffer, plus
+    #NUM_TLCS * 16 bytes for #tlc_channelFades.  Set it higher for more
+    fades at once, or to 0 if the sketch always gives tlc_initFadePool() its
+    own arena. */
+#define TLC_FADE_BUFFER_LENGTH    12
+#endif
+#endif
+
+/** What tlc_addFade() does when the fade pool is full: returns 0 (the
+    default) */
+#define TLC_FADE_REJECT         0
+/** What tlc_addFade() does when the fade pool is full: drops the running
+    fade that started first (or, if none are running, the waiting fade that
+    starts first).  Its channel stays where the fade left it. */
+#define TLC_FADE_DROP_OLDEST    1
+/** What tlc_addFade() does when the fade pool is full: replaces a fade on
+    the same channel (or group), or returns 0 if there isn't one. */
+#define TLC_FADE_MERGE          2
+
+#ifndef TLC_FADE_TICKS
+/** What the fade times (startMillis, endMillis) count.
+    - 0 milliseconds, from millis() (default)
+    - 1 PWM periods, from tlc_getPwmTicks() (needs #TLC_PWM_TICKS).  Fades
+        keep working with Timer0 turned off, and with tlc_startFades() they
+        step in time with the XLAT interrupt that steps them. */
+#define TLC_FADE_TICKS    0
+#endif
+
+#if TLC_FADE_TICKS && !TLC_PWM_TICKS
+#error "TLC_FADE_TICKS requires TLC_PWM_TICKS in tlc_config.h"
 #endif
 
-/** Data for a single fade */
+#if TLC_FADE_TICKS
+/** The current fade time, see #TLC_FADE_TICKS */
+#define tlc_fadeTime()    tlc_getPwmTicks()
+#else
+/** The current fade time, see #TLC_FADE_TICKS */
+#define tlc_fadeTime()    millis()
+#endif
+
+/** True if the fade time now is at or after time.  The times are compared
+    by their signed difference, so this keeps working when the clock wraps
+    (after about 49.7 days of millis()) as long as the two are less than
+    2^31 apart. */
+#define tlc_timeReached(now, time)    ((int32_t)((now) - (time)) >= 0)
+
+/** Data for a single fade, see tlc_addFade(struct Tlc_Fade *) */
 struct Tlc_Fade {
     TLC_CHANNEL_TYPE channel; /**< channel this fade is on */
     int16_t startValue;       /**< value when the fade starts (0 - 4095) */
     int16_t changeValue;      /**< start + changeValue = endValue (0 - 4095) */
-    uint32_t startMillis;     /**< millis() when to start */
-    uint32_t endMillis;       /**< millis() when to end */
-} tlc_fadeBuffer[TLC_FADE_BUFFER_LENGTH];
+    uint32_t startMillis;     /**< tlc_fadeTime() when to start */
+    uint32_t endMillis;       /**< tlc_fadeTime() when to end */
+};
+
+#ifndef TLC_NUM_FADE_GROUPS
+/** How many groups tlc_addGroupFade() can use (2 bytes of ram each) */
+#define TLC_NUM_FADE_GROUPS    4
+#endif
+
+/** Set in Tlc_FadeState::curve for a group fade (its channel is the group) */
+#define TLC_FADE_GROUP    0x80
+
+/** Channels that fade together, see tlc_addGroupFade() */
+struct Tlc_FadeGroup {
+    uint8_t *channels;     /**< #NUM_TLCS * 2 bytes, bit (channel & 7) of
+                                byte (channel >> 3) is set for each channel
+                                in the group */
+    uint16_t *startValues; /**< start value of each channel in the group,
+                                lowest channel first, or 0 to use the fade's
+                                startValue for all of them */
+    uint16_t *endValues;   /**< same for the end values */
+};
+
+/** The groups for tlc_addGroupFade() */
+struct Tlc_FadeGroup *tlc_fadeGroups[TLC_NUM_FADE_GROUPS];
+
+/** Set in Tlc_FadeState::state once the fade has started */
+#define TLC_FADE_RUNNING    0x80
+
+/** A fade in the fade pool.  With #TLC_FADE_COMPACT there's no value: each
+    step works out how far along the fade is from the time left, and the
+    fields every step reads come first.  Without it (the default) the value
+    is kept in 16.16 fixed point and stepped by slope every millisecond, so
+    tlc_updateFades() doesn't divide.  A fade on a curve steps how far along
+    the curve it is (0 - 4095) instead, see tlc_curve().
+
+    Fades never move in the pool.  Each one is on one of three lists, linked
+    by fade number (its index in the pool + 1, 0 ends a list): the running
+    fades, the waiting fades or the free slots.  A fade on a channel (not a
+    group) is also on the channel's list in #tlc_channelFades. */
+#if TLC_FADE_COMPACT
+struct Tlc_FadeState {
+    uint8_t next;             /**< the next fade on its list */
+    uint8_t state;            /**< TLC_FADE_RUNNING | generation (0 - 127,
+                                   odd while the fade is in the pool) */
+    uint16_t end;             /**< tlc_fadeTime() when to end -
+                                   #tlc_fadeEpoch */
+    uint16_t duration;        /**< end - the tlc_fadeTime() when to start */
+    uint8_t values[3];        /**< value at the start and at the end (0 -
+                                   4095), packed like a #GS_DUO */
+    uint8_t curve;            /**< TLC_CURVE_LINEAR, TLC_CURVE_EASE_IN, ...
+                                   | TLC_FADE_GROUP */
+    TLC_CHANNEL_TYPE channel; /**< channel (or group) this fade is on */
+    uint8_t prev;             /**< the previous fade on its list */
+    uint8_t channelNext;      /**< the next fade on the same channel */
+};
+
+/** The tlc_fadeTime() that Tlc_FadeState::end counts from.  tlc_addFade()
+    moves it up to the first end in the pool when a fade doesn't fit. */
+uint32_t tlc_fadeEpoch;
 
-/** The current fade buffer size */
+/** The tlc_fadeTime() a fade starts at */
+#define tlc_fadeStartTime(p)   (tlc_fadeEpoch + (p)->end - (p)->duration)
+/** The tlc_fadeTime() a fade ends at */
+#define tlc_fadeEndTime(p)     (tlc_fadeEpoch + (p)->end)
+/** The value a fade starts at (0 - 4095) */
+#define tlc_fadeStartValue(p)  (((uint16_t)(p)->values[0] << 4) \
+                                | ((p)->values[1] >> 4))
+/** The value a fade ends at (0 - 4095) */
+#define tlc_fadeEndValue(p)    ((((uint16_t)(p)->values[1] & 0xF) << 8) \
+                                | (p)->values[2])
+#else
+struct Tlc_FadeState {
+    TLC_CHANNEL_TYPE channel; /**< channel (or group) this fade is on */
+    uint8_t curve;            /**< TLC_CURVE_LINEAR, TLC_CURVE_EASE_IN, ...
+                                   | TLC_FADE_GROUP */
+    uint8_t next;             /**< the next fade on its list */
+    uint8_t prev;             /**< the previous fade on its list */
+    uint8_t channelNext;      /**< the next fade on the same channel */
+    uint8_t state;            /**< TLC_FADE_RUNNING | generation (0 - 127,
+                                   odd while the fade is in the pool and
+                                   bumped when it ends, so its handle stops
+                                   matching) */
+    int16_t startValue;       /**< value at startMillis (0 - 4095) */
+    int16_t endValue;         /**< value at endMillis (0 - 4095) */
+    int32_t value;            /**< current value (or curve position) << 16 */
+    int32_t slope;            /**< change per millisecond << 16 */
+    uint32_t startMillis;     /**< tlc_fadeTime() when to start, once started
+                                   the time it was last stepped to */
+    uint32_t endMillis;       /**< tlc_fadeTime() when to end */
+};
+
+/** The tlc_fadeTime() a fade starts at (or was last stepped to) */
+#define tlc_fadeStartTime(p)   ((p)->startMillis)
+/** The tlc_fadeTime() a fade ends at */
+#define tlc_fadeEndTime(p)     ((p)->endMillis)
+/** The value a fade starts at (0 - 4095) */
+#define tlc_fadeStartValue(p)  ((p)->startValue)
+/** The value a fade ends at (0 - 4095) */
+#define tlc_fadeEndValue(p)    ((p)->endValue)
+#endif
+
+#if TLC_FADE_BUFFER_LENGTH
+/** The default fade pool */
+struct Tlc_FadeState tlc_fadeBuffer[TLC_FADE_BUFFER_LENGTH];
+/** The fade pool, see tlc_initFadePool() */
+struct Tlc_FadeState *tlc_fadePool = tlc_fadeBuffer;
+#else
+struct Tlc_FadeState *tlc_fadePool;
+#endif
+
+/** The number of fades in #tlc_fadePool (up to 255) */
+uint8_t tlc_fadePoolLength = TLC_FADE_BUFFER_LENGTH;
+
+/** The fades after the first tlc_fadePoolUsed of #tlc_fadePool have never
+    been used, so the pool doesn't have to be set up before the first fade.
+    The ones that ended are on the tlc_fadeFree list. */
+uint8_t tlc_fadePoolUsed;
+
+/** The first free fade (that has been used before) */
+uint8_t tlc_fadeFree;
+
+/** The first running fade.  The running fades are in the order they
+    started, so this one started first. */
+uint8_t tlc_fadeActive;
+
+/** The last running fade, where tlc_updateFades() adds the fades it starts */
+uint8_t tlc_fadeActiveTail;
+
+/** The first waiting fade.  The waiting fades are sorted by startMillis, so
+    tlc_updateFades() only looks at this one. */
+uint8_t tlc_fadePending;
+
+/** TLC_FADE_REJECT, TLC_FADE_DROP_OLDEST or TLC_FADE_MERGE */
+uint8_t tlc_fadeOverflow;
+
+/** The current fade buffer size (started and waiting fades) */
 uint8_t tlc_fadeBufferSize;
 
+/** The number of fades that have started */
+uint8_t tlc_fadeActiveSize;
+
+/** The fade number of the last fade added on each channel (0 if the channel
+    has no fades), the rest follow Tlc_FadeState::channelNext.  Ending or
+    removing a fade only walks its own channel's fades. */
+uint8_t tlc_channelFades[NUM_TLCS * 16];
+
+/** The fade with fade number n (1 - #tlc_fadePoolLength) */
+#define tlc_fadeAt(n)    (tlc_fadePool + (n) - 1)
+
+/** The number of PWM periods between fade steps when tlc_startFades() is
+    stepping them - 1 */
+volatile uint16_t tlc_fadePeriodsPerStep;
+/** The number of periods left until the next fade step */
+volatile uint16_t tlc_fadePeriodsWait;
+
 uint8_t tlc_updateFades();
 uint8_t tlc_updateFades(uint32_t currentMillis);
-uint8_t tlc_addFade(struct Tlc_Fade *fade);
-uint8_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
-                    int16_t endValue, uint32_t startMillis, uint32_t endMillis);
+void tlc_startFades(uint16_t periodsPerStep);
+void tlc_stopFades(void);
+volatile void tlc_fadesXLATCallback(void);
+void tlc_initFadePool(struct Tlc_FadeState *arena, uint8_t length,
+                      uint8_t overflow = TLC_FADE_REJECT);
+uint16_t tlc_addFade(struct Tlc_Fade *fade);
+uint16_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
+                     int16_t endValue, uint32_t startMillis,
+                     uint32_t endMillis, uint8_t curve = TLC_CURVE_LINEAR);
+uint16_t tlc_addGroupFade(uint8_t group, int16_t startValue,
+                          int16_t endValue, uint32_t startMillis,
+                          uint32_t endMillis, uint8_t curve = TLC_CURVE_LINEAR);
+uint8_t tlc_cancelFade(uint16_t handle);
+uint16_t tlc_retargetFade(TLC_CHANNEL_TYPE channel, int16_t endValue,
+                          uint32_t duration);
 uint8_t tlc_isFading(TLC_CHANNEL_TYPE channel);
 uint8_t tlc_removeFades(TLC_CHANNEL_TYPE channel);
-static void tlc_removeFadeFromBuffer(struct Tlc_Fade *current,
-                                     struct Tlc_Fade *end);
+uint8_t tlc_removeGroupFades(uint8_t group);
+static uint8_t tlc_allocFade(void);
+static void tlc_freeFade(uint8_t n);
+static uint8_t tlc_fadeOfHandle(uint16_t handle);
+static uint8_t tlc_findFade(TLC_CHANNEL_TYPE channel, uint8_t group);
+static void tlc_setFadeValues(struct Tlc_FadeState *fade, int16_t startValue,
+                              int16_t endValue);
+#if TLC_FADE_COMPACT
+static uint8_t tlc_fitFadeEnd(uint32_t endMillis);
+#endif
+static uint8_t tlc_stepFades(uint32_t currentMillis);
+static void tlc_setFadeGroup(struct Tlc_FadeState *fade, uint16_t amount);
 
 /** \addtogroup ExtendedFunctions
     \code #include "tlc_fades.h" \endcode
      - uint8_t tlc_updateFades() - updates all fades
      - uint8_t tlc_updateFades(uint32_t currentMillis) - updates fades using
             currentMillis as the current time
-     - uint8_t tlc_addFade(struct Tlc_Fade *fade) - copies fade into the
+     - void tlc_startFades(uint16_t periodsPerStep) - updates fades from the
+            XLAT interrupt, so loop() doesn't have to
+     - void tlc_stopFades() - stops updating fades from the XLAT interrupt
+     - void tlc_initFadePool(struct Tlc_FadeState *arena, uint8_t length,
+            uint8_t overflow = TLC_FADE_REJECT) - keeps the fades in arena
+            and sets what happens when it's full
+     - uint16_t tlc_addFade(struct Tlc_Fade *fade) - copies fade into the
             fade buffer
-     - uint8_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
-            int16_t endValue, uint32_t startMillis, uint32_t endMillis) - adds
-            a fade to the fade buffer
+     - uint16_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
+            int16_t endValue, uint32_t startMillis, uint32_t endMillis,
+            uint8_t curve = TLC_CURVE_LINEAR) - adds a fade to the fade
+            buffer, optionally on a curve from tlc_curves.h.  Returns a
+            handle for the fade.
+     - uint16_t tlc_addGroupFade(uint8_t group, int16_t startValue,
+            int16_t endValue, uint32_t startMillis, uint32_t endMillis,
+            uint8_t curve = TLC_CURVE_LINEAR) - adds one fade for all the
+            channels of tlc_fadeGroups[group]
+     - uint8_t tlc_cancelFade(uint16_t handle) - removes the fade that
+            tlc_addFade() returned handle for
+     - uint16_t tlc_retargetFade(TLC_CHANNEL_TYPE channel, int16_t endValue,
+            uint32_t duration) - sends the fade on channel to a new
+            endValue from wherever it is now
      - uint8_t tlc_isFading(TLC_CHANNEL_TYPE channel) - returns 1 if there's
-            a fade on this channel in the buffer
+            a fade on this channel in the buffer (without searching it)
      - uint8_t tlc_removeFades(TLC_CHANNEL_TYPE channel) - removes all fades
-            on channel */
+            on channel
+     - uint8_t tlc_removeGroupFades(uint8_t group) - removes all fades on
+            group */
 /* @{ */
 
+/** Keeps the fades in arena instead of #tlc_fadeBuffer, so a sketch can
+    give them as much (or as little) ram as it has spare.  This removes any
+    fades and their handles stop working.  An example:
+    \code
+#include "tlc_fades.h"
+struct Tlc_FadeState sceneFades[64];
+
+// in setup()
+tlc_initFadePool(sceneFades, 64, TLC_FADE_DROP_OLDEST);
+    \endcode
+    \param arena room for length fades (they don't need to be cleared)
+    \param length number of fades in arena (up to 255)
+    \param overflow what tlc_addFade() does when the arena is full:
+           TLC_FADE_REJECT (the default), TLC_FADE_DROP_OLDEST or
+           TLC_FADE_MERGE */
+void tlc_initFadePool(struct Tlc_FadeState *arena, uint8_t length,
+                      uint8_t overflow)
+{
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
+    tlc_fadePool = arena;
+    tlc_fadePoolLength = length;
+    tlc_fadeOverflow = overflow;
+    tlc_fadePoolUsed = 0;
+    tlc_fadeFree = 0;
+    tlc_fadeActive = tlc_fadeActiveTail = 0;
+    tlc_fadePending = 0;
+    tlc_fadeBufferSize = 0;
+    tlc_fadeActiveSize = 0;
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        tlc_channelFades[channel] = 0;
+    }
+    SREG = oldSREG;
+}
+
 /** Adds a fade to the buffer.
     \param fade the fade to be copied into the buffer
-    \returns 0 if the fade buffer is full, fadeBufferSize if added successfully
+    \returns 0 if the fade buffer is full, the fade's handle otherwise, see
+             tlc_addFade()
 */
-uint8_t tlc_addFade(struct Tlc_Fade *fade)
+uint16_t tlc_addFade(struct Tlc_Fade *fade)
 {
-    if (tlc_fadeBufferSize == TLC_FADE_BUFFER_LENGTH) {
-        return 0; // fade buffer full
-    }
-    struct Tlc_Fade *p = tlc_fadeBuffer + tlc_fadeBufferSize++;
-    p->channel = fade->channel;
-    p->startValue = fade->startValue;
-    p->changeValue = fade->changeValue;
-    p->startMillis = fade->startMillis;
-    p->endMillis = fade->endMillis;
-    return tlc_fadeBufferSize;
+    return tlc_addFade(fade->channel, fade->startValue,
+                       fade->startValue + fade->changeValue,
+                       fade->startMillis, fade->endMillis);
 }
 
-/** Adds a fade to the fade buffer.
+/** Adds a fade to the fade buffer.  This is the only place a fade's slope is
+    divided out.  The fade waits in startMillis order (after any fades with
+    the same startMillis) until tlc_updateFades() starts it.  When the pool
+    is full, what happens depends on the overflow given to
+    tlc_initFadePool().
+
+    Interrupts are off for a fixed amount of work: taking a slot, checking
+    the place found for it and linking it in.  The walk down the waiting
+    fades to find that place (up to 254 of them) runs with interrupts on,
+    and is walked again if the XLAT interrupt started the fade before the
+    new one in the meantime (see tlc_startFades()), at most once for each
+    fade that starts.
     \param channel the ouput channel this fade is on
     \param startValue the value at the start of the fade
     \param endValue the value at the end of the fade
-    \param startMillis the millis() when to start the fade
-    \param endMillis the millis() when to end the fade
-    \returns 0 if the fade buffer is full, fadeBufferSize if added successfully
+    \param startMillis the tlc_fadeTime() when to start the fade
+    \param endMillis the tlc_fadeTime() when to end the fade
+    \param curve how the value goes from startValue to endValue:
+           TLC_CURVE_LINEAR (the default), TLC_CURVE_EASE_IN,
+           TLC_CURVE_EASE_OUT, TLC_CURVE_EASE_IN_OUT, TLC_CURVE_GAMMA or a
+           curve set with tlc_setCurve()
+    \returns 0 if the fade buffer is full, otherwise a handle (!= 0) for
+             tlc_cancelFade().  The handle stops working once the fade ends
+             or is removed (until its slot has been reused 64 times).
 */
-uint8_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
-                    int16_t endValue, uint32_t startMillis, uint32_t endMillis)
+uint16_t tlc_addFade(TLC_CHANNEL_TYPE channel, int16_t startValue,
+                     int16_t endValue, uint32_t startMillis,
+                     uint32_t endMillis, uint8_t curve)
 {
-    if (tlc_fadeBufferSize == TLC_FADE_BUFFER_LENGTH) {
-        return 0; // fade buffer full
+    int32_t duration = (int32_t)(endMillis - startMillis);
+#if TLC_FADE_COMPACT
+    if (duration < 0) {
+        duration = 0; // (done as soon as it starts)
+        endMillis = startMillis;
+    } else if (duration > 0xFFFF) {
+        return 0;
+    }
+#else
+    int32_t change = curve == TLC_CURVE_LINEAR?
+            endValue - startValue : 4095; // (steps along the curve)
+    int32_t slope = duration > 0? change * 65536 / duration : 0;
+#endif
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
+#if TLC_FADE_COMPACT
+    if (!tlc_fitFadeEnd(endMillis)) {
+        SREG = oldSREG;
+        return 0;
+    }
+#endif
+    uint8_t n = tlc_allocFade();
+    if (!n && tlc_fadeBufferSize) { // full
+        uint8_t old = 0;
+        if (tlc_fadeOverflow == TLC_FADE_DROP_OLDEST) {
+            old = tlc_fadeActive? tlc_fadeActive : tlc_fadePending;
+        } else if (tlc_fadeOverflow == TLC_FADE_MERGE) {
+            old = tlc_findFade(channel, curve & TLC_FADE_GROUP);
+        }
+        if (old) {
+            tlc_freeFade(old);
+            n = tlc_allocFade();
+        }
+    }
+    if (!n) {
+        SREG = oldSREG;
+        return 0;
+    }
+    uint8_t prev, next;
+    for (;;) {
+        SREG = oldSREG; // the XLAT interrupt only takes fades off the front
+        prev = 0;
+        next = tlc_fadePending;
+        while (next && tlc_timeReached(startMillis,
+                                       tlc_fadeStartTime(tlc_fadeAt(next)))) {
+            prev = next;
+            next = tlc_fadeAt(next)->next;
+        }
+        cli();
+        if (prev? (tlc_fadeAt(prev)->state & (TLC_FADE_RUNNING | 1)) == 1
+                   && tlc_fadeAt(prev)->next == next
+                 : tlc_fadePending == next) {
+            break; // prev is still waiting, right before next
+        }
+    }
+    struct Tlc_FadeState *p = tlc_fadeAt(n);
+    p->prev = prev;
+    p->next = next;
+    if (prev) {
+        tlc_fadeAt(prev)->next = n;
+    } else {
+        tlc_fadePending = n;
+    }
+    if (next) {
+        tlc_fadeAt(next)->prev = n;
+    }
+    tlc_fadeBufferSize++;
+    if (!(curve & TLC_FADE_GROUP)) {
+        p->channelNext = tlc_channelFades[channel];
+        tlc_channelFades[channel] = n;
     }
-    struct Tlc_Fade *p = tlc_fadeBuffer + tlc_fadeBufferSize++;
     p->channel = channel;
-    p->startValue = startValue;
-    p->changeValue = endValue - startValue;
+    p->curve = curve;
+    tlc_setFadeValues(p, startValue, endValue);
+#if TLC_FADE_COMPACT
+    p->end = endMillis - tlc_fadeEpoch;
+    p->duration = duration;
+#else
+    p->value = curve == TLC_CURVE_LINEAR? (int32_t)startValue << 16 : 0;
+    p->slope = slope;
     p->startMillis = startMillis;
     p->endMillis = endMillis;
-    return tlc_fadeBufferSize;
+#endif
+    uint16_t handle = ((uint16_t)p->state << 8) | n;
+    SREG = oldSREG;
+    return handle;
 }
 
-/** Checks to see if any fades are happening on channel
+/** Adds one fade for every channel of a group.  It takes a single slot in
+    the fade buffer, and each step works out the curve once and packs the
+    channels straight into #tlc_GSData (two at a time where both channels of
+    a #GS_DUO are in the group).  An example:
+    \code
+#include "tlc_fades.h"
+uint8_t washChannels[NUM_TLCS * 2] = {0xFF, 0xFF, 0xFF, 0xFF}; // 0 - 31
+struct Tlc_FadeGroup wash = {washChannels, 0, 0};
+
+// in setup()
+tlc_fadeGroups[0] = &wash;
+tlc_addGroupFade(0, 0, 4095, millis(), millis() + 2000, TLC_CURVE_GAMMA);
+    \endcode
+    Group fades don't count for tlc_isFading() or tlc_removeFades(), use
+    tlc_removeGroupFades().
+    \param group index in #tlc_fadeGroups (0 - #TLC_NUM_FADE_GROUPS - 1)
+    \param startValue the value of every channel at the start of the fade
+           (unless the group has startValues)
+    \param endValue the value of every channel at the end of the fade (unless
+           the group has endValues)
+    \param startMillis the tlc_fadeTime() when to start the fade
+    \param endMillis the tlc_fadeTime() when to end the fade
+    \param curve see tlc_addFade()
+    \returns 0 if the fade buffer is full, a handle otherwise, see
+             tlc_addFade()
+*/
+uint16_t tlc_addGroupFade(uint8_t group, int16_t startValue,
+                          int16_t endValue, uint32_t startMillis,
+                          uint32_t endMillis, uint8_t curve)
+{
+    return tlc_addFade(group, startValue, endValue, startMillis, endMillis,
+                       curve | TLC_FADE_GROUP);
+}
+
+/** Checks to see if any fades are happening on channel.  This only reads
+    the channel's entry in #tlc_channelFades.
     \param channel the channel to check
     \returns 1 if there is a fade in the buffer on this channel, 0 otherwise */
 uint8_t tlc_isFading(TLC_CHANNEL_TYPE channel)
 {
-    struct Tlc_Fade *end = tlc_fadeBuffer + tlc_fadeBufferSize;
-    for (struct Tlc_Fade *p = tlc_fadeBuffer; p < end; p++) {
-        if (p->channel == channel) {
-            return 1;
+    return tlc_channelFades[channel] != 0;
+}
+
+/** Finds a fade on a channel (from #tlc_channelFades) or on a group (by
+    looking through the running and waiting fades).
+    \param channel the channel (or group) to look for
+    \param group 0 for a channel, TLC_FADE_GROUP for a group
+    \returns the fade number of one found, 0 if there isn't one */
+static uint8_t tlc_findFade(TLC_CHANNEL_TYPE channel, uint8_t group)
+{
+    if (!group) {
+        return tlc_channelFades[channel];
+    }
+    for (uint8_t n = tlc_fadeActive; n; n = tlc_fadeAt(n)->next) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        if (p->channel == channel && (p->curve & TLC_FADE_GROUP) == group) {
+            return n;
+        }
+    }
+    for (uint8_t n = tlc_fadePending; n; n = tlc_fadeAt(n)->next) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        if (p->channel == channel && (p->curve & TLC_FADE_GROUP) == group) {
+            return n;
         }
     }
     return 0;
 }
 
-/** Removes any fades from the fade buffer on this channel.
+/** Removes any fades from the fade buffer on this channel.  Only the
+    channel's own fades are touched, from #tlc_channelFades.
     \param channel which channel the fades are on
     \returns how many fades were removed */
 uint8_t tlc_removeFades(TLC_CHANNEL_TYPE channel)
 {
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
+    uint8_t removed = 0;
+    uint8_t n;
+    while ((n = tlc_channelFades[channel])) {
+        tlc_freeFade(n);
+        removed++;
+    }
+    SREG = oldSREG;
+    return removed;
+}
+
+/** Removes any fades from the fade buffer on this group.
+    \param group which group the fades are on
+    \returns how many fades were removed */
+uint8_t tlc_removeGroupFades(uint8_t group)
+{
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
     uint8_t removed = 0;
-    struct Tlc_Fade *end = tlc_fadeBuffer + tlc_fadeBufferSize;
-    for (struct Tlc_Fade *p = tlc_fadeBuffer; p < end; p++) {
-        if (p->channel == channel) {
+    for (uint8_t n = tlc_fadeActive; n;) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        uint8_t next = p->next;
+        if (p->channel == group && (p->curve & TLC_FADE_GROUP)) {
             removed++;
-            tlc_removeFadeFromBuffer(p, --end);
+            tlc_freeFade(n);
         }
+        n = next;
     }
+    for (uint8_t n = tlc_fadePending; n;) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        uint8_t next = p->next;
+        if (p->channel == group && (p->curve & TLC_FADE_GROUP)) {
+            removed++;
+            tlc_freeFade(n);
+        }
+        n = next;
+    }
+    SREG = oldSREG;
     return removed;
 }
 
-/** Copies the end of the buffer to the current and decrements
-    tlc_fadeBufferSize.  This will change the end of the buffer (pass by
-    reference)
-    \param current the fade to be removed
-    \param endp the end of the fade buffer (pointer to pointer) */
-static void tlc_removeFadeFromBuffer(struct Tlc_Fade *current,
-                                     struct Tlc_Fade *endp)
+/** Removes a fade by the handle tlc_addFade() returned for it, without
+    searching for it.  The channel stays where the fade left it.
+    \param handle from tlc_addFade() or tlc_addGroupFade()
+    \returns 1 if the fade was removed, 0 if it had already ended or been
+             removed */
+uint8_t tlc_cancelFade(uint16_t handle)
 {
-    if (endp != current) { // if this is not the last fade
-        current->channel = endp->channel;
-        current->startValue = endp->startValue;
-        current->changeValue = endp->changeValue;
-        current->startMillis = endp->startMillis;
-        current->endMillis = endp->endMillis;
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
+    uint8_t n = tlc_fadeOfHandle(handle);
+    if (n) {
+        tlc_freeFade(n);
+    }
+    SREG = oldSREG;
+    return n != 0;
+}
+
+/** Changes where the running fade on channel is going, in place: it
+    continues from the value it last set the channel to (keeping the
+    fraction of a linear fade) and gets to endValue duration later, on the
+    same curve.  There's no tlc_removeFades() and Tlc.get() to do first,
+    so this is cheap enough to call for every new target of a sensor.  An
+    example:
+    \code
+#include "tlc_fades.h"
+
+// in loop(), whenever a new reading comes in
+tlc_retargetFade(0, analogRead(0) * 4, 100);
+tlc_updateFades();
+    \endcode
+    With #TLC_FADE_COMPACT it continues from Tlc.get(channel) and duration
+    counts from tlc_fadeTime().
+    If there's more than one running fade on channel, this changes the one
+    that was added first.  If there's none (there may be waiting fades) this
+    adds a linear fade from Tlc.get(channel), starting at tlc_fadeTime().
+    \param channel the channel to fade
+    \param endValue the new value at the end of the fade (0 - 4095)
+    \param duration how long from the last step of the fade (in
+           tlc_fadeTime() units, milliseconds by default) to get to
+           endValue
+    \returns the handle of the fade, 0 if a fade had to be added and the
+             fade buffer is full (or, with #TLC_FADE_COMPACT, if the new end
+             doesn't fit) */
+uint16_t tlc_retargetFade(TLC_CHANNEL_TYPE channel, int16_t endValue,
+                          uint32_t duration)
+{
+    uint8_t oldSREG = SREG;
+    cli(); // the XLAT interrupt could be stepping fades, see tlc_startFades()
+    uint8_t n = 0;
+    for (uint8_t m = tlc_channelFades[channel]; m;
+            m = tlc_fadeAt(m)->channelNext) {
+        if (tlc_fadeAt(m)->state & TLC_FADE_RUNNING) {
+            n = m; // the last one in the list was added first
+        }
+    }
+    if (!n) {
+        SREG = oldSREG;
+        uint32_t now = tlc_fadeTime();
+        return tlc_addFade(channel, Tlc.get(channel), endValue, now,
+                           now + duration);
+    }
+    struct Tlc_FadeState *p = tlc_fadeAt(n);
+#if TLC_FADE_COMPACT
+    uint32_t now = tlc_fadeTime();
+    if (duration > 0xFFFF || !tlc_fitFadeEnd(now + duration)) {
+        SREG = oldSREG;
+        return 0;
+    }
+    tlc_setFadeValues(p, Tlc.get(channel), endValue); // (its last step)
+    p->end = now + duration - tlc_fadeEpoch;
+    p->duration = duration;
+#else
+    if (p->curve == TLC_CURVE_LINEAR) {
+        p->startValue = p->value >> 16;
+        p->slope = duration? (((int32_t)endValue << 16) - p->value)
+                             / (int32_t)duration : 0;
+    } else {
+        p->startValue += (int16_t)(((int32_t)(p->endValue - p->startValue)
+                         * tlc_curve(p->curve, p->value >> 16)) >> 12);
+        p->value = 0; // back to the start of the curve
+        p->slope = duration? (int32_t)4095 * 65536 / (int32_t)duration : 0;
+    }
+    p->endValue = endValue;
+    p->endMillis = p->startMillis + duration;
+#endif
+    uint16_t handle = ((uint16_t)(p->state & ~TLC_FADE_RUNNING) << 8) | n;
+    SREG = oldSREG;
+    return handle;
+}
+
+/** Finds the fade of a handle.
+    \param handle from tlc_addFade()
+    \returns the fade number, or 0 if the fade has ended or been removed */
+static uint8_t tlc_fadeOfHandle(uint16_t handle)
+{
+    uint8_t n = (uint8_t)handle;
+    if (n == 0 || n > tlc_fadePoolUsed
+            || (tlc_fadeAt(n)->state & ~TLC_FADE_RUNNING) != (handle >> 8)) {
+        return 0;
+    }
+    return n;
+}
+
+/** Sets the values a fade goes between.
+    \param fade the fade
+    \param startValue the value at the start (0 - 4095)
+    \param endValue the value at the end (0 - 4095) */
+static void tlc_setFadeValues(struct Tlc_FadeState *fade, int16_t startValue,
+                              int16_t endValue)
+{
+#if TLC_FADE_COMPACT
+    fade->values[0] = startValue >> 4;
+    fade->values[1] = ((uint8_t)(startValue << 4)) | ((endValue >> 8) & 0xF);
+    fade->values[2] = (uint8_t)endValue;
+#else
+    fade->startValue = startValue;
+    fade->endValue = endValue;
+#endif
+}
+
+#if TLC_FADE_COMPACT
+
+/** Makes sure a fade ending at endMillis fits in Tlc_FadeState::end.  If it
+    doesn't, #tlc_fadeEpoch moves to the first end of the fades in the pool
+    (or to endMillis, if that's first) and every end is moved down with it.
+    \param endMillis the tlc_fadeTime() a fade will end at
+    \returns 1 if it fits, 0 if a fade in the pool ends more than 65535
+             ticks before or after endMillis */
+static uint8_t tlc_fitFadeEnd(uint32_t endMillis)
+{
+    int32_t offset = (int32_t)(endMillis - tlc_fadeEpoch);
+    if (offset >= 0 && offset <= 0xFFFF) {
+        return 1;
+    }
+    int32_t first = offset;
+    int32_t last = offset;
+    for (uint8_t n = 1; n <= tlc_fadePoolUsed; n++) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        if (p->state & 1) { // in use
+            if (p->end < first) {
+                first = p->end;
+            }
+            if (p->end > last) {
+                last = p->end;
+            }
+        }
+    }
+    if (last - first > 0xFFFF) {
+        return 0;
+    }
+    for (uint8_t n = 1; n <= tlc_fadePoolUsed; n++) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        if (p->state & 1) {
+            p->end -= first;
+        }
+    }
+    tlc_fadeEpoch += first;
+    return 1;
+}
+
+#endif
+
+/** Takes a fade from the free list, or one that has never been used.
+    \returns the fade number, 0 if the pool is full */
+static uint8_t tlc_allocFade(void)
+{
+    uint8_t n = tlc_fadeFree;
+    if (n) {
+        tlc_fadeFree = tlc_fadeAt(n)->next;
+    } else if (tlc_fadePoolUsed < tlc_fadePoolLength) {
+        n = ++tlc_fadePoolUsed;
+    } else {
+        return 0;
+    }
+    struct Tlc_FadeState *p = tlc_fadeAt(n);
+    p->state = (p->state | 1) & ~TLC_FADE_RUNNING; // in use, waiting
+    return n;
+}
+
+/** Unlinks a fade from the running or waiting list (and its channel's
+    list), puts it on the free list and bumps its generation so its handle
+    stops working.
+    \param n the fade number */
+static void tlc_freeFade(uint8_t n)
+{
+    struct Tlc_FadeState *p = tlc_fadeAt(n);
+    uint8_t running = p->state & TLC_FADE_RUNNING;
+    if (!(p->curve & TLC_FADE_GROUP)) {
+        uint8_t *link = &tlc_channelFades[p->channel];
+        while (*link != n) { // only this channel's fades
+            link = &tlc_fadeAt(*link)->channelNext;
+        }
+        *link = p->channelNext;
+    }
+    if (p->prev) {
+        tlc_fadeAt(p->prev)->next = p->next;
+    } else if (running) {
+        tlc_fadeActive = p->next;
+    } else {
+        tlc_fadePending = p->next;
+    }
+    if (p->next) {
+        tlc_fadeAt(p->next)->prev = p->prev;
+    } else if (running) {
+        tlc_fadeActiveTail = p->prev;
+    }
+    if (running) {
+        tlc_fadeActiveSize--;
     }
     tlc_fadeBufferSize--;
+    p->state = (p->state + 2) & 0x7E; // free, the next generation
+    p->next = tlc_fadeFree;
+    tlc_fadeFree = n;
 }
 
-/** Updates fades using millis()
+/** Updates fades using tlc_fadeTime() (millis(), or the PWM periods with
+    #TLC_FADE_TICKS)
     \returns 0 if there are no fades left in the buffer. */
 uint8_t tlc_updateFades()
 {
-    return tlc_updateFades(millis());
+    return tlc_updateFades(tlc_fadeTime());
 }
 
-/** Updates any running fades.
-    \param currentMillis the current millis() time.
-    \returns 0 if there are no fades left in the buffer. */
-uint8_t tlc_updateFades(uint32_t currentMillis)
+/** Starts the fades whose startMillis has come, then steps every running
+    fade and sets its channel.  The fades that are still waiting cost
+    nothing.  With #TLC_FADE_COMPACT each running fade divides the time it
+    has run by its duration.  Without it, each one is stepped by its slope
+    times the milliseconds since it was last stepped, which is a single add
+    when this is called every millisecond.  The last value of a fade is
+    always exactly its endValue.
+    \param currentMillis the current time (see tlc_fadeTime()).
+    \returns 1 if any channel was set (needs an update), 0 otherwise */
+static uint8_t tlc_stepFades(uint32_t currentMillis)
 {
-    struct Tlc_Fade *end = tlc_fadeBuffer + tlc_fadeBufferSize;
+    while (tlc_fadePending
+            && tlc_timeReached(currentMillis,
+                               tlc_fadeStartTime(tlc_fadeAt(tlc_fadePending)))) {
+        uint8_t n = tlc_fadePending; // starts the fade
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        tlc_fadePending = p->next;
+        if (tlc_fadePending) {
+            tlc_fadeAt(tlc_fadePending)->prev = 0;
+        }
+        p->state |= TLC_FADE_RUNNING;
+        p->prev = tlc_fadeActiveTail;
+        p->next = 0;
+        if (tlc_fadeActiveTail) {
+            tlc_fadeAt(tlc_fadeActiveTail)->next = n;
+        } else {
+            tlc_fadeActive = n;
+        }
+        tlc_fadeActiveTail = n;
+        tlc_fadeActiveSize++;
+    }
+
     uint8_t needsUpdate = 0;
-    for (struct Tlc_Fade *p = tlc_fadeBuffer; p < end;){
-        if (currentMillis >= p->endMillis) { // fade done
-            Tlc.set(p->channel, p->startValue + p->changeValue);
-            needsUpdate = 1;
-            tlc_removeFadeFromBuffer(p, --end);
+    uint8_t next;
+    for (uint8_t n = tlc_fadeActive; n; n = next) {
+        struct Tlc_FadeState *p = tlc_fadeAt(n);
+        next = p->next;
+        needsUpdate = 1;
+        if (tlc_timeReached(currentMillis, tlc_fadeEndTime(p))) { // fade done
+            if (p->curve & TLC_FADE_GROUP) {
+                tlc_setFadeGroup(p, 4096);
+                tlc_freeFade(n);
+                continue;
+            }
+            Tlc.set(p->channel, tlc_fadeEndValue(p));
+            tlc_freeFade(n);
             continue;
-        } else {
-            uint32_t startMillis = p->startMillis;
-            if (currentMillis >= startMillis) {
-                Tlc.set(p->channel, p->startValue + p->changeValue
-                        * (int32_t)(currentMillis - startMillis)
-                        / (int32_t)(p->endMillis - startMillis));
-                needsUpdate = 1;
+        }
+#if TLC_FADE_COMPACT
+        // how far along it is (0 - 4095), the end hasn't come
+        uint16_t left = tlc_fadeEndTime(p) - currentMillis;
+        uint16_t value = ((uint32_t)(p->duration - left) << 12) / p->duration;
+#else
+        uint32_t elapsed = currentMillis - p->startMillis;
+        p->startMillis = currentMillis;
+        if (elapsed == 1) {
+            p->value += p->slope;
+        } else if (elapsed) {
+            p->value += p->slope * (int32_t)elapsed;
+        }
+        uint16_t value = p->value >> 16;
+#endif
+        if (p->curve & TLC_FADE_GROUP) {
+            tlc_setFadeGroup(p, tlc_curve(p->curve & ~TLC_FADE_GROUP, value));
+            continue;
+        }
+        if (TLC_FADE_COMPACT || p->curve != TLC_CURVE_LINEAR) {
+            int16_t start = tlc_fadeStartValue(p);
+            value = start + (int16_t)(((int32_t)(tlc_fadeEndValue(p) - start)
+                    * tlc_curve(p->curve, value)) >> 12);
+        }
+        Tlc.set(p->channel, value);
+    }
+    return needsUpdate;
+}
+
+/** Sets every channel of a group fade to amount / 4096 of the way from its
+    start value to its end value.  Pairs of channels in the same #GS_DUO are
+    packed with tlc_setDuo(), like Tlc.setRange().
+    \param fade a group fade
+    \param amount (0 - 4096) how far along the fade is, from tlc_curve() */
+static void tlc_setFadeGroup(struct Tlc_FadeState *fade, uint16_t amount)
+{
+    struct Tlc_FadeGroup *group = tlc_fadeGroups[fade->channel];
+    int16_t startValue = tlc_fadeStartValue(fade);
+    int16_t endValue = tlc_fadeEndValue(fade);
+    uint16_t value = startValue + (int16_t)(((int32_t)(endValue - startValue)
+                     * amount) >> 12);
+    uint16_t values[2] = {value, value};
+    uint16_t member = 0; // index in startValues / endValues
+    uint8_t *p = tlc_GSData + NUM_TLCS * 24;
+    uint8_t changed = 0;
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel += 2, p -= 3) {
+        uint8_t bits = group->channels[channel >> 3];
+        if (!bits) {
+            channel += 6; // none of the 8 channels of this byte
+            p -= 9;
+            continue;
+        }
+        bits = (bits >> (channel & 7)) & 3; // this channel and the next
+        if (!bits) {
+            continue;
+        }
+        for (uint8_t i = 0; i < 2; i++) {
+            if ((bits & (1 << i)) && (group->startValues || group->endValues)) {
+                int16_t start = group->startValues?
+                        group->startValues[member] : startValue;
+                int16_t end = group->endValues?
+                        group->endValues[member] : endValue;
+                values[i] = start + (int16_t)(((int32_t)(end - start)
+                            * amount) >> 12);
+                member++;
             }
         }
-        p++;
+        if (bits == 3) {
+            changed |= tlc_setDuo(p - 3, values[1], values[0]);
+        } else if (bits == 1) {
+            Tlc.set(channel, values[0]);
+        } else {
+            Tlc.set(channel + 1, values[1]);
+        }
     }
-    if (needsUpdate) {
-        Tlc.update();
-        if (tlc_fadeBufferSize == 0) {
-            while (tlc_needXLAT)
-                ;
+    if (changed) {
+        tlc_markGSDirty();
+    }
+}
+
+/** Updates any running fades.  Don't call this while tlc_startFades() is
+    running.
+    \param currentMillis the current time (see tlc_fadeTime()).
+    \returns 0 if there are no fades left in the buffer. */
+uint8_t tlc_updateFades(uint32_t currentMillis)
+{
+    if (tlc_stepFades(currentMillis)) {
+        tlc_present();
+#if !TLC_DOUBLE_BUFFER
+        if (tlc_fadeBufferSize == 0) { // the last frame of a fade can't be
+            while (tlc_needXLAT)       // dropped, Tlc.commit() never drops
+                ;                      // a frame
         }
+#endif
     }
     return tlc_fadeBufferSize;
 }
 
+/** Steps the fades from the XLAT interrupt (with tlc_onUpdateFinished, like
+    tlc_playAnimation()), so they stay smooth however long loop() takes.
+    Every periodsPerStep + 1 PWM periods the interrupt does what
+    tlc_updateFades() does, except wait for the XLAT.  That takes at most
+    #tlc_fadePoolLength fade steps and one Tlc.update(), and
+    tlc_addFade() and tlc_removeFades() turn interrupts off while they change
+    the buffer.  Nothing else should call Tlc.update() or use
+    tlc_onUpdateFinished until tlc_stopFades().
+    \param periodsPerStep number of PWM periods to wait between steps (0
+           steps every period).  The default PWM period for a 16MHz clock is
+           1.024ms. */
+void tlc_startFades(uint16_t periodsPerStep)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    tlc_fadePeriodsPerStep = periodsPerStep;
+    tlc_fadePeriodsWait = 0;
+    tlc_onUpdateFinished = tlc_fadesXLATCallback;
+    set_XLAT_interrupt(); // the first step is after the next PWM period
+    SREG = oldSREG;
+}
+
+/** Stops stepping the fades from the XLAT interrupt.  The fades stay in the
+    buffer for tlc_updateFades() or the next tlc_startFades(). */
+void tlc_stopFades(void)
+{
+    tlc_onUpdateFinished = 0;
+}
+
+/** This is called by the XLAT interrupt every PWM period after
+    tlc_startFades().  A step of a full pool can take longer than a PWM
+    period; the XLAT interrupts that come while it runs don't call it again
+    (see TIMER1_OVF_vect), they're skipped.  The fades stay on time since
+    each step reads tlc_fadeTime(). */
+volatile void tlc_fadesXLATCallback(void)
+{
+    if (tlc_fadePeriodsWait) {
+        tlc_fadePeriodsWait--;
+    } else {
+        tlc_fadePeriodsWait = tlc_fadePeriodsPerStep;
+        if (tlc_stepFades(tlc_fadeTime())) {
+            tlc_present();
+        }
+    }
+    if (!tlc_needXLAT) { // (an update sets the XLAT interrupt itself)
+        set_XLAT_interrupt();
+    }
+}
+
 /* @} */
 
 #endif
@@ -0,0 +1,210 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_INTERPOLATION_H
+#define TLC_INTERPOLATION_H
+
+/** \file
+    Interpolated animations: keyframes from PROGMEM (in the format of
+    tlc_playAnimation()) blended every PWM period.  This is apart from
+    tlc_animations.h because the blend needs 4 bytes of ram a channel,
+    which only sketches that include this pay for. */
+
+#include "tlc_config.h"
+#include "Tlc5940.h"
+#include "tlc_animations.h"
+#include "tlc_curves.h"
+
+/** Each channel at the last keyframe, in #tlc_GSData order (the odd channel
+    of each #GS_DUO first) */
+uint16_t tlc_interpolationStart[NUM_TLCS * 16];
+/** Each channel's change to the next keyframe, same order */
+int16_t tlc_interpolationDelta[NUM_TLCS * 16];
+/** How far to the next keyframe, 0 - 4096 in 16.16 fixed point */
+uint32_t tlc_interpolationT;
+/** Added to tlc_interpolationT every PWM period */
+uint32_t tlc_interpolationStep;
+/** PWM periods since the last keyframe */
+uint16_t tlc_interpolationPeriod;
+/** The curve between keyframes, TLC_CURVE_LINEAR, ... (see tlc_curves.h) */
+uint8_t tlc_interpolationCurve;
+
+volatile void tlc_interpolationXLATCallback(void);
+void tlc_playInterpolatedAnimation(prog_uint8_t *animation, uint16_t frames,
+        uint16_t periodsPerFrame, uint8_t curve = TLC_CURVE_LINEAR);
+#if TLC_FAR_PROGMEM
+void tlc_playInterpolatedFarAnimation(uint_farptr_t animation,
+        uint16_t frames, uint16_t periodsPerFrame,
+        uint8_t curve = TLC_CURVE_LINEAR);
+#endif
+static void tlc_startInterpolation(TLC_ANIMATION_ADDRESS animation,
+        uint16_t frames, uint16_t periodsPerFrame, uint8_t curve);
+static void tlc_loadKeyframe(void);
+static void tlc_interpolateFrame(uint16_t t);
+
+/** \addtogroup ExtendedFunctions
+    \code #include "tlc_interpolation.h" \endcode
+    - void tlc_playInterpolatedAnimation(prog_uint8_t *animation,
+            uint16_t frames, uint16_t periodsPerFrame, uint8_t curve) -
+            plays keyframes from progmem, blending between them every PWM
+            period.
+    - void tlc_playInterpolatedFarAnimation(uint_farptr_t animation,
+            uint16_t frames, uint16_t periodsPerFrame, uint8_t curve) -
+            tlc_playInterpolatedAnimation() anywhere in flash
+            (#TLC_FAR_PROGMEM). */
+/* @{ */
+
+/** Plays keyframes from progmem, blending from each one to the next every
+    PWM period instead of holding it like tlc_playAnimation().  A slow fade
+    takes two keyframes instead of a frame per step:
+    \code
+// 16 keyframes, 500 PWM periods (about half a second) apart
+tlc_playInterpolatedAnimation(ani_keys, ANI_KEYS_FRAMES, 500);
+// the same, easing in and out of each keyframe
+tlc_playInterpolatedAnimation(ani_keys, ANI_KEYS_FRAMES, 500,
+                              TLC_CURVE_EASE_IN_OUT);
+    \endcode
+    The XLAT interrupt steps a shared 16.16 position and does one multiply
+    per channel each period, no division.  The last keyframe's values and
+    the change to the next live in ram (4 bytes a channel).  Each keyframe
+    is shown exactly.
+    \param animation A progmem array of keyframes, length NUM_TLCS * 24 *
+           frames, in reverse order (the same format as tlc_playAnimation()).
+           Ensure that there is not an update waiting to happen before
+           calling this.
+    \param frames the number of keyframes in animation
+    \param periodsPerFrame number of PWM periods from one keyframe to the
+           next (at least 1)
+    \param curve TLC_CURVE_LINEAR, TLC_CURVE_EASE_IN, ... (see
+           tlc_curves.h), applied between each pair of keyframes */
+void tlc_playInterpolatedAnimation(prog_uint8_t *animation, uint16_t frames,
+        uint16_t periodsPerFrame, uint8_t curve)
+{
+    tlc_startInterpolation(tlc_animationAddress(animation), frames,
+                           periodsPerFrame, curve);
+}
+
+#if TLC_FAR_PROGMEM
+
+/** tlc_playInterpolatedAnimation() for keyframes anywhere in flash.
+    \param animation the flash address (pgm_get_far_address()) of the
+           keyframes
+    \param frames the number of keyframes in animation
+    \param periodsPerFrame number of PWM periods from one keyframe to the
+           next (at least 1)
+    \param curve TLC_CURVE_LINEAR, TLC_CURVE_EASE_IN, ... */
+void tlc_playInterpolatedFarAnimation(uint_farptr_t animation,
+        uint16_t frames, uint16_t periodsPerFrame, uint8_t curve)
+{
+    tlc_startInterpolation(animation, frames, periodsPerFrame, curve);
+}
+
+#endif
+
+/** Shows the first keyframe and starts blending from the XLAT interrupt. */
+static void tlc_startInterpolation(TLC_ANIMATION_ADDRESS animation,
+        uint16_t frames, uint16_t periodsPerFrame, uint8_t curve)
+{
+    if (!frames) {
+        return;
+    }
+    if (!periodsPerFrame) {
+        periodsPerFrame = 1;
+    }
+    tlc_currentAnimation = animation;
+    tlc_animationFrames = frames - 1;
+    tlc_animationPeriodsPerFrame = periodsPerFrame;
+    tlc_interpolationStep = (4096UL << 16) / periodsPerFrame;
+    tlc_interpolationPeriod = 0;
+    tlc_interpolationCurve = curve;
+    tlc_setGSfromAnimation(tlc_animationFrame(tlc_animationFrames));
+    tlc_onUpdateFinished = tlc_interpolationXLATCallback;
+    tlc_present();
+}
+
+/** Loads the blend from the keyframe in #tlc_GSData to the next one. */
+static void tlc_loadKeyframe(void)
+{
+    TLC_ANIMATION_ADDRESS p = tlc_animationFrame(tlc_animationFrames - 1);
+    uint8_t *gsDatap = tlc_GSData;
+    uint16_t *startp = tlc_interpolationStart;
+    int16_t *deltap = tlc_interpolationDelta;
+    while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+        uint8_t a0 = *gsDatap++, a1 = *gsDatap++, a2 = *gsDatap++;
+        uint8_t b0 = tlc_readAnimation(p++);
+        uint8_t b1 = tlc_readAnimation(p++);
+        uint8_t b2 = tlc_readAnimation(p++);
+        uint16_t odd = ((uint16_t)a0 << 4) | (a1 >> 4);
+        uint16_t even = ((uint16_t)(a1 & 0x0F) << 8) | a2;
+        *startp++ = odd;
+        *deltap++ = (int16_t)(((uint16_t)b0 << 4) | (b1 >> 4)) - odd;
+        *startp++ = even;
+        *deltap++ = (int16_t)(((uint16_t)(b1 & 0x0F) << 8) | b2) - even;
+    }
+    tlc_interpolationT = 0;
+}
+
+/** Sets #tlc_GSData to the blend t of the way to the next keyframe.
+    \param t (0 - 4095) */
+static void tlc_interpolateFrame(uint16_t t)
+{
+    uint8_t *gsDatap = tlc_GSData;
+    uint16_t *startp = tlc_interpolationStart;
+    int16_t *deltap = tlc_interpolationDelta;
+    uint8_t changed = 0;
+    while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+        uint16_t odd = *startp++ + (int16_t)(((int32_t)*deltap++ * t) >> 12);
+        uint16_t even = *startp++ + (int16_t)(((int32_t)*deltap++ * t) >> 12);
+        changed |= tlc_setDuo(gsDatap, odd, even);
+        gsDatap += 3;
+    }
+    if (changed) { // (a slow blend repeats a frame for a few periods)
+        tlc_markGSDirty();
+    }
+}
+
+/** This is called by the XLAT interrupt every PWM period while an
+    interpolated animation plays.  If blending a frame takes longer than a
+    PWM period it isn't re-entered (see TIMER1_OVF_vect), the animation
+    plays a period slower for each period it overruns. */
+volatile void tlc_interpolationXLATCallback(void)
+{
+    if (tlc_interpolationPeriod == 0) { // at a keyframe
+        if (!tlc_animationFrames) { // animation is done
+            tlc_onUpdateFinished = 0;
+            return;
+        }
+        tlc_loadKeyframe();
+    }
+    if (++tlc_interpolationPeriod == tlc_animationPeriodsPerFrame) {
+        tlc_setGSfromAnimation(tlc_animationFrame(--tlc_animationFrames));
+        tlc_interpolationPeriod = 0;
+    } else {
+        tlc_interpolationT += tlc_interpolationStep;
+        tlc_interpolateFrame(tlc_curve(tlc_interpolationCurve,
+                                       tlc_interpolationT >> 16));
+    }
+    tlc_present();
+    if (!tlc_needXLAT) { // nothing changed (an update sets it itself)
+        set_XLAT_interrupt();
+    }
+}
+
+/* @} */
+
+#endif
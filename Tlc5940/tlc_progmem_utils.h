@@ -23,13 +23,21 @@
     PROGMEM utility functions for setting grayscale or dot correction data
     from PROGMEM.  See the UsingProgmem Example for an example. */
 
+#if defined(__AVR__)
 #include <avr/pgmspace.h>
 #include <avr/io.h>
+#endif
 
 #include "tlc_config.h"
 #include "Tlc5940.h"
 
 void tlc_setGSfromProgmem(prog_uint8_t *gsArray);
+void tlc_setRangeFromProgmem(TLC_CHANNEL_TYPE firstChannel,
+                             const prog_uint16_t *values, uint16_t count);
+#if TLC_FAR_PROGMEM
+void tlc_setGSfromFarProgmem(uint_farptr_t gsArray);
+void tlc_copyFromFarProgmem(uint8_t *dest, uint_farptr_t src, uint8_t count);
+#endif
 #if VPRG_ENABLED
 void tlc_setDCfromProgmem(prog_uint8_t *dcArray);
 #endif
@@ -39,6 +47,14 @@ void tlc_setDCfromProgmem(prog_uint8_t *dcArray);
     - void tlc_setGSfromProgmem(prog_uint8_t *gsArray) - copies the progmem
       grayscale to current grayscale array.  Requires a
       \link Tlc5940::update Tlc.update() \endlink.
+    - void tlc_setRangeFromProgmem(uint8_t firstChannel,
+      prog_uint16_t *values, uint16_t count) - Tlc.setRange() from a progmem
+      array of grayscale values.  Requires a Tlc.update().
+    - void tlc_setGSfromFarProgmem(uint_farptr_t gsArray) - like
+      tlc_setGSfromProgmem() anywhere in flash (#TLC_FAR_PROGMEM).
+    - void tlc_copyFromFarProgmem(uint8_t *dest, uint_farptr_t src,
+      uint8_t count) - copies 1 - 255 bytes from anywhere in flash
+      (#TLC_FAR_PROGMEM).
     - void tlc_setDCfromProgmem(prog_uint8_t *dcArray) - shifts the data from a
       progmem dot correction array (doesn't need an update). */
 /* @{ */
@@ -74,8 +90,128 @@ void tlc_setGSfromProgmem(prog_uint8_t *gsArray)
         *gsDatap++ = pgm_read_byte(gsArrayp++);
         *gsDatap++ = pgm_read_byte(gsArrayp++);
     }
+    tlc_markGSDirty();
+}
+
+/** Sets count channels from firstChannel up from an array of values in
+    progmem.  This is \link Tlc5940::setRange Tlc.setRange() \endlink with
+    the values read by pgm_read_word().  An example:
+    \code
+#include "tlc_progmem_utils.h"
+prog_uint16_t ramp[8] PROGMEM = {0, 585, 1170, 1755, 2340, 2925, 3510, 4095};
+
+// sometime after Tlc.init()
+tlc_setRangeFromProgmem(4, ramp, 8); // channels 4 to 11
+Tlc.update();
+    \endcode
+    \param firstChannel the channel for values[0]
+    \param values a progmem array of grayscale values (0 - 4095)
+    \param count number of values */
+void tlc_setRangeFromProgmem(TLC_CHANNEL_TYPE firstChannel,
+                             const prog_uint16_t *values, uint16_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    uint16_t channel = firstChannel;
+    if (channel & 1) { // shares its GS_DUO with a channel that isn't set
+        Tlc.set(channel++, pgm_read_word(values++));
+        count--;
+    }
+    uint8_t *p = tlc_duoOf(channel + 1) + 3;
+    uint8_t changed = 0;
+    while (count >= 2) {
+        p -= 3;
+        uint16_t evenValue = pgm_read_word(values++);
+        changed |= tlc_setDuo(p, pgm_read_word(values++), evenValue);
+        channel += 2;
+        count -= 2;
+    }
+    if (changed) {
+        tlc_markGSDirty();
+    }
+    if (count) {
+        Tlc.set(channel, pgm_read_word(values));
+    }
+}
+
+#if TLC_FAR_PROGMEM
+
+/** Sets the grayscale data from an array anywhere in flash, for arrays
+    placed above the first 64 KB on the ATmega1280/2560.  An example:
+    \code
+#include "tlc_progmem_utils.h"
+prog_uint8_t gsArray1[NUM_TLCS * 24] PROGMEM = { ... };
+
+// sometime after Tlc.init()
+tlc_setGSfromFarProgmem(pgm_get_far_address(gsArray1));
+Tlc.update();
+    \endcode
+    RAMPZ is loaded once and ELPM Z+ steps through the array (carrying into
+    RAMPZ at 64 KB boundaries), so this is as fast as tlc_setGSfromProgmem().
+    \param gsArray the flash address of the grayscale data
+           (pgm_get_far_address()). */
+void tlc_setGSfromFarProgmem(uint_farptr_t gsArray)
+{
+#if defined(__AVR__) && defined(RAMPZ)
+    uint8_t oldRAMPZ = RAMPZ;
+    RAMPZ = (uint8_t)(gsArray >> 16);
+    uint16_t z = (uint16_t)gsArray;
+    uint8_t *gsDatap = tlc_GSData;
+    uint16_t duos = NUM_TLCS * 8;
+    asm volatile(
+        "1:"                            "\n\t"
+        "elpm __tmp_reg__, Z+"          "\n\t"
+        "st X+, __tmp_reg__"            "\n\t"
+        "elpm __tmp_reg__, Z+"          "\n\t"
+        "st X+, __tmp_reg__"            "\n\t"
+        "elpm __tmp_reg__, Z+"          "\n\t"
+        "st X+, __tmp_reg__"            "\n\t"
+        "sbiw %[duos], 1"               "\n\t"
+        "brne 1b"
+        : [duos] "+w" (duos), "+x" (gsDatap), "+z" (z)
+        :
+        : "memory");
+    RAMPZ = oldRAMPZ;
+#else
+    uint8_t *gsDatap = tlc_GSData;
+    while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+        *gsDatap++ = pgm_read_byte_far(gsArray++);
+        *gsDatap++ = pgm_read_byte_far(gsArray++);
+        *gsDatap++ = pgm_read_byte_far(gsArray++);
+    }
+#endif
+    tlc_markGSDirty();
+}
+
+/** Copies bytes from anywhere in flash to ram with one ELPM Z+ per byte.
+    \param dest where to copy to
+    \param src the flash address to copy from (pgm_get_far_address())
+    \param count number of bytes (1 - 255) */
+void tlc_copyFromFarProgmem(uint8_t *dest, uint_farptr_t src, uint8_t count)
+{
+#if defined(__AVR__) && defined(RAMPZ)
+    uint8_t oldRAMPZ = RAMPZ;
+    RAMPZ = (uint8_t)(src >> 16);
+    uint16_t z = (uint16_t)src;
+    asm volatile(
+        "1:"                            "\n\t"
+        "elpm __tmp_reg__, Z+"          "\n\t"
+        "st X+, __tmp_reg__"            "\n\t"
+        "dec %[count]"                  "\n\t"
+        "brne 1b"
+        : [count] "+r" (count), "+x" (dest), "+z" (z)
+        :
+        : "memory");
+    RAMPZ = oldRAMPZ;
+#else
+    do {
+        *dest++ = pgm_read_byte_far(src++);
+    } while (--count);
+#endif
 }
 
+#endif
 
 #if VPRG_ENABLED
 
@@ -111,10 +247,36 @@ void tlc_setDCfromProgmem(prog_uint8_t *dcArray)
     tlc_dcModeStart();
 
     prog_uint8_t *p = dcArray;
+#if DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+    uint8_t bytes[TLC_NUM_CHAINS];
+    prog_uint8_t *dcArrayEnd = dcArray + TLC_CHAIN_TLCS * 12;
+    while (p < dcArrayEnd) { // same order as Tlc.update()
+        prog_uint8_t *chainp = p++;
+        uint8_t *bytep = bytes + TLC_NUM_CHAINS;
+        while (bytep > bytes) {
+            *--bytep = pgm_read_byte(chainp);
+            chainp += TLC_CHAIN_TLCS * 12;
+        }
+        tlc_shift8Chains(bytes);
+    }
+#elif DATA_TRANSFER_MODE == TLC_SPI
+    prog_uint8_t *dcArrayEnd = dcArray + NUM_TLCS * 12;
+    SPDR = pgm_read_byte(p++); // starts transmission
+    tlc_spiNext8(pgm_read_byte(p++));
+    tlc_spiNext8(pgm_read_byte(p++));
+    while (p < dcArrayEnd) { // the next byte is read while one is sent
+        tlc_spiNext8(pgm_read_byte(p++));
+        tlc_spiNext8(pgm_read_byte(p++));
+        tlc_spiNext8(pgm_read_byte(p++));
+    }
+    tlc_spiWait();
+#else
     prog_uint8_t *dcArrayEnd = dcArray + NUM_TLCS * 12;
     while (p < dcArrayEnd) {
         tlc_shift8(pgm_read_byte(p++));
     }
+#endif
+    tlc_shift8_wait();
     XLAT_PORT |= _BV(XLAT_PIN);
     XLAT_PORT &= ~_BV(XLAT_PIN);
 
@@ -22,7 +22,9 @@
 /** \file
     TLC servo functions. */
 
+#if defined(__AVR__)
 #include <avr/io.h>
+#endif
 #include "Tlc5940.h"
 
 #ifndef SERVO_MAX_ANGLE
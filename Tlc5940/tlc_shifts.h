@@ -52,6 +52,7 @@ uint16_t tlc_shiftUp(uint16_t zeroValue)
     *(tlc_GSData + NUM_TLCS * 24 - 2) = (*(tlc_GSData + NUM_TLCS * 24 - 1) << 4)
                                       | ((zeroValue & 0x0F00) >> 8);
     *(tlc_GSData + NUM_TLCS * 24 - 1) = (uint8_t)zeroValue;
+    tlc_markGSDirty();
     return topValue;
 }
 
@@ -72,6 +73,7 @@ uint16_t tlc_shiftDown(uint16_t topValue)
     }
     *(tlc_GSData + 1) = (*tlc_GSData >> 4) | ((uint8_t)topValue << 4);
     *tlc_GSData = topValue >> 4;
+    tlc_markGSDirty();
     return zeroValue;
 }
 
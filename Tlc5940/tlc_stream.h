@@ -0,0 +1,395 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_STREAM_H
+#define TLC_STREAM_H
+
+/** \file
+    Streaming animations: frames come from a struct Tlc_FrameSource (progmem,
+    a ram ring buffer, the serial port, a file on an SD card, ...) into a
+    small FIFO that loop() keeps full with tlc_streamFill().  The XLAT
+    interrupt shows a frame from the FIFO every periodsPerFrame PWM periods,
+    like tlc_playAnimation(). */
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#endif
+
+#include "tlc_config.h"
+#include "Tlc5940.h"
+
+#ifndef TLC_STREAM_FRAMES
+/** Frames in the read-ahead FIFO (#NUM_TLCS * 24 bytes of ram each), a
+    power of 2.  More frames ride out longer stalls in the source. */
+#define TLC_STREAM_FRAMES    4
+#endif
+
+#if TLC_STREAM_FRAMES & (TLC_STREAM_FRAMES - 1)
+#error "TLC_STREAM_FRAMES must be a power of 2"
+#endif
+
+/** The source read a whole frame */
+#define TLC_FRAME_READY    0
+/** The next frame isn't there yet, try again later */
+#define TLC_FRAME_WAIT     1
+/** There are no more frames */
+#define TLC_FRAME_END      2
+
+/** Where a streamed animation's frames come from.  The source structs below
+    start with one, so a pointer to any of them can be passed as
+    &source.source. */
+struct Tlc_FrameSource {
+    /** Reads the next frame (#NUM_TLCS * 24 bytes, in #tlc_GSData order)
+        into frame and returns TLC_FRAME_READY, TLC_FRAME_WAIT or
+        TLC_FRAME_END.  After TLC_FRAME_WAIT it's called again with the same
+        frame, so it can fill it a few bytes at a time. */
+    uint8_t (*read)(struct Tlc_FrameSource *source, uint8_t *frame);
+};
+
+/** Frames in progmem, in the reverse order tlc_playAnimation() uses. */
+struct Tlc_ProgmemSource {
+    struct Tlc_FrameSource source;
+    /** The animation */
+    prog_uint8_t *frames;
+    /** Frames left to read */
+    uint16_t count;
+};
+
+/** Frames written into a ram ring buffer with tlc_ringWrite(), from loop()
+    or an interrupt (a serial receive or network handler). */
+struct Tlc_RingSource {
+    struct Tlc_FrameSource source;
+    /** The ring buffer */
+    uint8_t *buffer;
+    /** The size of buffer, a power of 2 of at least #NUM_TLCS * 24 */
+    uint16_t size;
+    /** Bytes read, wraps */
+    volatile uint16_t head;
+    /** Bytes written, wraps */
+    volatile uint16_t tail;
+    /** Set by tlc_ringEnd() */
+    volatile uint8_t ended;
+};
+
+/** Frames read a few bytes at a time from a stream, like Serial or a File
+    on an SD card. */
+struct Tlc_StreamSource {
+    struct Tlc_FrameSource source;
+    /** Reads up to count bytes into buffer.  Returns how many were read (0
+        if none are there yet) or -1 at the end of the stream. */
+    int16_t (*read)(uint8_t *buffer, uint16_t count);
+    /** Bytes of the next frame read so far */
+    uint16_t have;
+};
+
+/** The source of the playing stream */
+struct Tlc_FrameSource *tlc_streamSource;
+/** The read-ahead FIFO */
+uint8_t tlc_streamFifo[TLC_STREAM_FRAMES][NUM_TLCS * 24];
+/** Frames taken from the FIFO by the XLAT interrupt, wraps */
+volatile uint8_t tlc_streamHead;
+/** Frames put into the FIFO by tlc_streamFill(), wraps */
+volatile uint8_t tlc_streamTail;
+/** Set when the source returns TLC_FRAME_END */
+volatile uint8_t tlc_streamEnded;
+/** Times a frame was due and the FIFO was empty.  The last frame stays up
+    for another PWM period each time, so frames are late but never
+    dropped. */
+volatile uint16_t tlc_streamUnderruns;
+/** The number of PWM periods to display each frame - 1 */
+volatile uint16_t tlc_streamPeriodsPerFrame;
+/** The current number of periods we've displayed this frame for */
+volatile uint16_t tlc_streamPeriodsWait;
+
+volatile void tlc_streamXLATCallback(void);
+void tlc_playStream(struct Tlc_FrameSource *source, uint16_t periodsPerFrame);
+uint8_t tlc_streamFill(void);
+void tlc_initProgmemSource(struct Tlc_ProgmemSource *source,
+                           prog_uint8_t *frames, uint16_t count);
+void tlc_initRingSource(struct Tlc_RingSource *source, uint8_t *buffer,
+                        uint16_t size);
+uint16_t tlc_ringWrite(struct Tlc_RingSource *source, const uint8_t *bytes,
+                       uint16_t count);
+void tlc_ringEnd(struct Tlc_RingSource *source);
+void tlc_initStreamSource(struct Tlc_StreamSource *source,
+                          int16_t (*read)(uint8_t *buffer, uint16_t count));
+static uint8_t tlc_progmemSourceRead(struct Tlc_FrameSource *source,
+                                     uint8_t *frame);
+static uint8_t tlc_ringSourceRead(struct Tlc_FrameSource *source,
+                                  uint8_t *frame);
+static uint8_t tlc_streamSourceRead(struct Tlc_FrameSource *source,
+                                    uint8_t *frame);
+
+/** \addtogroup ExtendedFunctions
+    \code #include "tlc_stream.h" \endcode
+    - void tlc_playStream(struct Tlc_FrameSource *source,
+            uint16_t periodsPerFrame) - plays frames from a source in the
+            background.
+    - uint8_t tlc_streamFill(void) - reads frames from the source until the
+            FIFO is full, call this from loop().
+    - void tlc_initProgmemSource(struct Tlc_ProgmemSource *source,
+            prog_uint8_t *frames, uint16_t count) - a source for a progmem
+            animation.
+    - void tlc_initRingSource(struct Tlc_RingSource *source, uint8_t *buffer,
+            uint16_t size) - a source for a ram ring buffer.
+    - uint16_t tlc_ringWrite(struct Tlc_RingSource *source,
+            const uint8_t *bytes, uint16_t count) - adds bytes to a ring.
+    - void tlc_ringEnd(struct Tlc_RingSource *source) - ends a ring's frames.
+    - void tlc_initStreamSource(struct Tlc_StreamSource *source,
+            int16_t (*read)(uint8_t *buffer, uint16_t count)) - a source for
+            a byte stream (Serial, a File). */
+/* @{ */
+
+/** Plays frames from a source in the "background" (with interrupts).  An
+    example that streams frames over the serial port:
+    \code
+#include "tlc_stream.h"
+
+struct Tlc_StreamSource serialFrames;
+
+int16_t readSerial(uint8_t *buffer, uint16_t count)
+{
+  uint16_t available = Serial.available();
+  return Serial.readBytes((char *)buffer, min(count, available));
+}
+
+// in setup()
+Tlc.init();
+Serial.begin(115200);
+tlc_initStreamSource(&serialFrames, readSerial);
+tlc_playStream(&serialFrames.source, 15);
+
+// in loop()
+tlc_streamFill();
+    \endcode
+    The FIFO is filled before the first frame is shown.  Check if the stream
+    is done with !tlc_onUpdateFinished.
+    \param source where the frames come from.  Ensure that there is not an
+           update waiting to happen before calling this.
+    \param periodsPerFrame number of PWM periods to wait between each frame
+           (0 means play the frames as fast as they come). */
+void tlc_playStream(struct Tlc_FrameSource *source, uint16_t periodsPerFrame)
+{
+    tlc_onUpdateFinished = 0;
+    tlc_streamSource = source;
+    tlc_streamHead = tlc_streamTail = 0;
+    tlc_streamEnded = 0;
+    tlc_streamUnderruns = 0;
+    tlc_streamPeriodsPerFrame = periodsPerFrame;
+    tlc_streamPeriodsWait = 0;
+    tlc_streamFill();
+    tlc_onUpdateFinished = tlc_streamXLATCallback;
+    tlc_streamXLATCallback();
+}
+
+/** Reads frames from the source into the FIFO until it's full or the source
+    has to wait.  Call this from loop() often enough to stay a frame ahead
+    of the XLAT interrupt.
+    \returns the number of frames waiting in the FIFO */
+uint8_t tlc_streamFill(void)
+{
+    while (!tlc_streamEnded && (uint8_t)(tlc_streamTail - tlc_streamHead)
+                               < TLC_STREAM_FRAMES) {
+        uint8_t result = tlc_streamSource->read(tlc_streamSource,
+                tlc_streamFifo[tlc_streamTail & (TLC_STREAM_FRAMES - 1)]);
+        if (result == TLC_FRAME_WAIT) {
+            break;
+        }
+        if (result == TLC_FRAME_END) {
+            tlc_streamEnded = 1;
+            break;
+        }
+        tlc_streamTail++;
+    }
+    return tlc_streamTail - tlc_streamHead;
+}
+
+/** This is called by the XLAT interrupt every PWM period while a stream
+    plays.  Copies the next frame from the FIFO into #tlc_GSData, or counts
+    an underrun and tries again next period if it's empty. */
+volatile void tlc_streamXLATCallback(void)
+{
+    if (tlc_streamPeriodsWait) {
+        tlc_streamPeriodsWait--;
+        set_XLAT_interrupt();
+    } else if (tlc_streamHead != tlc_streamTail) {
+        uint8_t *framep =
+                tlc_streamFifo[tlc_streamHead & (TLC_STREAM_FRAMES - 1)];
+        uint8_t *gsDatap = tlc_GSData;
+        while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+            *gsDatap++ = *framep++;
+            *gsDatap++ = *framep++;
+            *gsDatap++ = *framep++;
+        }
+        tlc_streamHead++;
+        tlc_markGSDirty();
+        tlc_streamPeriodsWait = tlc_streamPeriodsPerFrame;
+        tlc_present();
+    } else if (tlc_streamEnded) { // stream is done
+        tlc_onUpdateFinished = 0;
+    } else {
+        tlc_streamUnderruns++;
+        set_XLAT_interrupt();
+    }
+}
+
+/** Sets up a source for a progmem animation (the same array
+    tlc_playAnimation() plays).
+    \param source the source to set up
+    \param frames A progmem array of grayscale data, length NUM_TLCS *
+           24 * count, in reverse order
+    \param count the number of frames */
+void tlc_initProgmemSource(struct Tlc_ProgmemSource *source,
+                           prog_uint8_t *frames, uint16_t count)
+{
+    source->source.read = tlc_progmemSourceRead;
+    source->frames = frames;
+    source->count = count;
+}
+
+/** Sets up a source for frames written into a ram ring buffer.
+    \param source the source to set up
+    \param buffer the ring buffer
+    \param size the size of buffer, a power of 2 of at least
+           #NUM_TLCS * 24 */
+void tlc_initRingSource(struct Tlc_RingSource *source, uint8_t *buffer,
+                        uint16_t size)
+{
+    source->source.read = tlc_ringSourceRead;
+    source->buffer = buffer;
+    source->size = size;
+    source->head = source->tail = 0;
+    source->ended = 0;
+}
+
+/** Adds bytes to a ring source, from loop() or an interrupt.
+    \param source the ring
+    \param bytes the bytes to add
+    \param count the number of bytes
+    \returns the number of bytes added (less than count if the ring is
+             full) */
+uint16_t tlc_ringWrite(struct Tlc_RingSource *source, const uint8_t *bytes,
+                       uint16_t count)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t head = source->head;
+    SREG = oldSREG;
+    uint16_t tail = source->tail;
+    uint16_t space = source->size - (uint16_t)(tail - head);
+    if (count > space) {
+        count = space;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        source->buffer[tail++ & (source->size - 1)] = bytes[i];
+    }
+    oldSREG = SREG;
+    cli();
+    source->tail = tail;
+    SREG = oldSREG;
+    return count;
+}
+
+/** Ends a ring source: the stream is done once the frames in the ring have
+    been shown.
+    \param source the ring */
+void tlc_ringEnd(struct Tlc_RingSource *source)
+{
+    source->ended = 1;
+}
+
+/** Sets up a source for frames read from a byte stream.
+    \param source the source to set up
+    \param read reads up to count bytes into buffer and returns how many
+           were read (0 if none are there yet) or -1 at the end of the
+           stream */
+void tlc_initStreamSource(struct Tlc_StreamSource *source,
+                          int16_t (*read)(uint8_t *buffer, uint16_t count))
+{
+    source->source.read = tlc_streamSourceRead;
+    source->read = read;
+    source->have = 0;
+}
+
+/** Reads the next progmem frame. */
+static uint8_t tlc_progmemSourceRead(struct Tlc_FrameSource *source,
+                                     uint8_t *frame)
+{
+    struct Tlc_ProgmemSource *progmem = (struct Tlc_ProgmemSource *)source;
+    if (!progmem->count) {
+        return TLC_FRAME_END;
+    }
+    prog_uint8_t *p = progmem->frames + --progmem->count * NUM_TLCS * 24;
+    uint8_t *framep = frame;
+    while (framep < frame + NUM_TLCS * 24) {
+        *framep++ = pgm_read_byte(p++);
+        *framep++ = pgm_read_byte(p++);
+        *framep++ = pgm_read_byte(p++);
+    }
+    return TLC_FRAME_READY;
+}
+
+/** Reads the next frame from a ring once all of it has been written. */
+static uint8_t tlc_ringSourceRead(struct Tlc_FrameSource *source,
+                                  uint8_t *frame)
+{
+    struct Tlc_RingSource *ring = (struct Tlc_RingSource *)source;
+    uint8_t ended = ring->ended; // before tail, so no bytes are left behind
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t tail = ring->tail;
+    SREG = oldSREG;
+    uint16_t head = ring->head;
+    if ((uint16_t)(tail - head) < NUM_TLCS * 24) {
+        return ended ? TLC_FRAME_END : TLC_FRAME_WAIT;
+    }
+    for (uint16_t i = 0; i < NUM_TLCS * 24; i++) {
+        frame[i] = ring->buffer[head++ & (ring->size - 1)];
+    }
+    oldSREG = SREG;
+    cli();
+    ring->head = head;
+    SREG = oldSREG;
+    return TLC_FRAME_READY;
+}
+
+/** Reads as much of the next frame as the stream has. */
+static uint8_t tlc_streamSourceRead(struct Tlc_FrameSource *source,
+                                    uint8_t *frame)
+{
+    struct Tlc_StreamSource *stream = (struct Tlc_StreamSource *)source;
+    while (stream->have < NUM_TLCS * 24) {
+        int16_t read = stream->read(frame + stream->have,
+                                    NUM_TLCS * 24 - stream->have);
+        if (read < 0) {
+            return TLC_FRAME_END;
+        }
+        if (read == 0) {
+            return TLC_FRAME_WAIT;
+        }
+        stream->have += read;
+    }
+    stream->have = 0;
+    return TLC_FRAME_READY;
+}
+
+/* @} */
+
+#endif
+
@@ -0,0 +1,252 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_TRACKS_H
+#define TLC_TRACKS_H
+
+/** \file
+    Plays several progmem animations at once.  Each track is an animation
+    (the same arrays as tlc_playAnimation()) on a set of channels, with its
+    own frame rate and a blend mode.  The XLAT interrupt merges the tracks
+    into #tlc_GSData in one pass whenever one of them moves to a new
+    frame. */
+
+#include "tlc_config.h"
+#include "Tlc5940.h"
+#include "tlc_animations.h"
+
+#ifndef TLC_NUM_TRACKS
+/** How many tracks can play at once (2 bytes of ram each) */
+#define TLC_NUM_TRACKS    4
+#endif
+
+/** The track's value replaces the tracks below it */
+#define TLC_BLEND_REPLACE    0
+/** The track's value is added to the tracks below it (up to 4095) */
+#define TLC_BLEND_ADD        1
+/** The brighter of the track's value and the tracks below it */
+#define TLC_BLEND_MAX        2
+
+/** An animation playing on some of the channels, see tlc_setTrack() */
+struct Tlc_Track {
+    TLC_ANIMATION_ADDRESS animation; /**< NUM_TLCS * 24 * frames bytes of
+                                          grayscale data in reverse order,
+                                          like tlc_playAnimation()
+                                          (tlc_animationAddress(array)) */
+    uint16_t frames;          /**< number of frames in animation */
+    uint16_t periodsPerFrame; /**< PWM periods to wait between frames */
+    uint8_t *channels;        /**< #NUM_TLCS * 2 bytes, bit (channel & 7) of
+                                   byte (channel >> 3) is set for each
+                                   channel the track plays on */
+    uint8_t blend;            /**< TLC_BLEND_REPLACE, TLC_BLEND_ADD or
+                                   TLC_BLEND_MAX */
+    uint8_t loop;             /**< non-zero to start over after the last
+                                   frame, 0 to hold the last frame */
+    uint16_t frame;           /**< the frame showing, counts down to 0 */
+    uint16_t periodsWait;     /**< periods left until the next frame */
+};
+
+/** The tracks, tlc_tracks[0] is at the bottom */
+struct Tlc_Track *tlc_tracks[TLC_NUM_TRACKS];
+/** Set when the tracks have to be merged again without a new frame */
+volatile uint8_t tlc_tracksChanged;
+
+void tlc_setTrack(uint8_t index, struct Tlc_Track *track);
+void tlc_startTracks(void);
+void tlc_stopTracks(void);
+volatile void tlc_tracksXLATCallback(void);
+static void tlc_mergeTracks(void);
+static inline uint16_t tlc_blend(uint8_t blend, uint16_t below,
+                                 uint16_t value);
+
+/** \addtogroup ExtendedFunctions
+    \code #include "tlc_tracks.h" \endcode
+    - void tlc_setTrack(uint8_t index, struct Tlc_Track *track) - starts a
+      track from its first frame (or removes one with track = 0)
+    - void tlc_startTracks(void) - plays the tracks from the XLAT interrupt
+    - void tlc_stopTracks(void) - stops playing the tracks */
+/* @{ */
+
+/** Puts a track in #tlc_tracks and starts it from its first frame.  An
+    example with a chase on the first 8 channels and a slow glow added on
+    top of all 16:
+    \code
+#include "tlc_tracks.h"
+
+uint8_t chaseChannels[NUM_TLCS * 2] = {0xFF, 0x00};
+uint8_t glowChannels[NUM_TLCS * 2] = {0xFF, 0xFF};
+struct Tlc_Track chase = {tlc_animationAddress(ani_chase), ANI_CHASE_FRAMES,
+                          20, chaseChannels, TLC_BLEND_REPLACE, 1};
+struct Tlc_Track glow = {tlc_animationAddress(ani_glow), ANI_GLOW_FRAMES,
+                         100, glowChannels, TLC_BLEND_ADD, 1};
+
+// in setup()
+Tlc.init();
+tlc_setTrack(0, &chase);
+tlc_setTrack(1, &glow);
+tlc_startTracks();
+    \endcode
+    Channels that no track plays on keep their value (Tlc.set() them, the
+    next merge shows them).
+    \param index the place in #tlc_tracks (0 - #TLC_NUM_TRACKS - 1), higher
+           tracks blend onto lower ones
+    \param track the track, or 0 to remove the track at index.  Its channels
+           keep their last values. */
+void tlc_setTrack(uint8_t index, struct Tlc_Track *track)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    if (track) { // the next XLAT interrupt moves it to the first frame
+        track->frame = track->frames;
+        track->periodsWait = 0;
+    }
+    tlc_tracks[index] = track;
+    tlc_tracksChanged = 1;
+    SREG = oldSREG;
+}
+
+/** Plays the tracks from the XLAT interrupt (with tlc_onUpdateFinished,
+    like tlc_playAnimation()).  Every PWM period each track counts down its
+    periodsPerFrame, and if any moved to a new frame the tracks are merged
+    and shifted out with one Tlc.update().  Nothing else should call
+    Tlc.update() or use tlc_onUpdateFinished until tlc_stopTracks(). */
+void tlc_startTracks(void)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    tlc_tracksChanged = 1;
+    tlc_onUpdateFinished = tlc_tracksXLATCallback;
+    set_XLAT_interrupt(); // the first merge is after the next PWM period
+    SREG = oldSREG;
+}
+
+/** Stops playing the tracks.  They stay in #tlc_tracks where they were for
+    the next tlc_startTracks(). */
+void tlc_stopTracks(void)
+{
+    tlc_onUpdateFinished = 0;
+}
+
+/** Blends a track's value onto the tracks below it.
+    \param blend TLC_BLEND_REPLACE, TLC_BLEND_ADD or TLC_BLEND_MAX
+    \param below (0 - 4095) the value from the tracks below
+    \param value (0 - 4095) the track's value
+    \returns (0 - 4095) */
+static inline uint16_t tlc_blend(uint8_t blend, uint16_t below,
+                                 uint16_t value)
+{
+    if (blend == TLC_BLEND_ADD) {
+        value += below;
+        return value > 4095 ? 4095 : value;
+    }
+    if (blend == TLC_BLEND_MAX && below > value) {
+        return below;
+    }
+    return value;
+}
+
+/** Merges the current frame of every track into #tlc_GSData.  One pass
+    over #tlc_GSData: each #GS_DUO is read once, blended with the same
+    #GS_DUO of each track that plays on one of its channels and written
+    back. */
+static void tlc_mergeTracks(void)
+{
+    struct Tlc_Track *tracks[TLC_NUM_TRACKS];
+    TLC_ANIMATION_ADDRESS framep[TLC_NUM_TRACKS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < TLC_NUM_TRACKS; i++) {
+        struct Tlc_Track *track = tlc_tracks[i];
+        if (track && track->frames) {
+            tracks[count] = track;
+            framep[count++] = track->animation
+                              + (uint32_t)track->frame * (NUM_TLCS * 24);
+        }
+    }
+    uint8_t *gsDatap = tlc_GSData;
+    uint16_t channel = NUM_TLCS * 16 - 1; // the odd channel of the GS_DUO
+    uint8_t changed = 0;
+    while (gsDatap < tlc_GSData + NUM_TLCS * 24) {
+        uint16_t odd = ((uint16_t)gsDatap[0] << 4) | (gsDatap[1] >> 4);
+        uint16_t even = ((uint16_t)(gsDatap[1] & 0x0F) << 8) | gsDatap[2];
+        uint8_t covered = 0; // bit 1 for odd, bit 0 for even
+        for (uint8_t i = 0; i < count; i++) {
+            struct Tlc_Track *track = tracks[i];
+            uint8_t mask = (track->channels[channel >> 3]
+                            >> ((channel - 1) & 7)) & 3;
+            if (mask) {
+                uint8_t b0 = tlc_readAnimation(framep[i]);
+                uint8_t b1 = tlc_readAnimation(framep[i] + 1);
+                uint8_t b2 = tlc_readAnimation(framep[i] + 2);
+                if (mask & 2) {
+                    uint16_t value = ((uint16_t)b0 << 4) | (b1 >> 4);
+                    odd = (covered & 2) ? tlc_blend(track->blend, odd, value)
+                                        : value;
+                }
+                if (mask & 1) {
+                    uint16_t value = ((uint16_t)(b1 & 0x0F) << 8) | b2;
+                    even = (covered & 1) ? tlc_blend(track->blend, even, value)
+                                         : value;
+                }
+                covered |= mask;
+            }
+            framep[i] += 3;
+        }
+        changed |= tlc_setDuo(gsDatap, odd, even);
+        gsDatap += 3;
+        channel -= 2;
+    }
+    if (changed) {
+        tlc_markGSDirty();
+    }
+}
+
+/** This is called by the XLAT interrupt every PWM period after
+    tlc_startTracks().  It isn't re-entered if a merge takes longer than a
+    PWM period (see TIMER1_OVF_vect): each period it overruns is skipped,
+    so the tracks fall behind by that many periods. */
+volatile void tlc_tracksXLATCallback(void)
+{
+    uint8_t changed = tlc_tracksChanged;
+    tlc_tracksChanged = 0;
+    for (uint8_t i = 0; i < TLC_NUM_TRACKS; i++) {
+        struct Tlc_Track *track = tlc_tracks[i];
+        if (!track || !track->frames) {
+            continue;
+        }
+        if (track->periodsWait) {
+            track->periodsWait--;
+        } else if (track->frame || track->loop) {
+            track->frame = track->frame ? track->frame - 1
+                                        : track->frames - 1;
+            track->periodsWait = track->periodsPerFrame;
+            changed = 1;
+        }
+    }
+    if (changed) {
+        tlc_mergeTracks();
+        tlc_present();
+    }
+    if (!tlc_needXLAT) { // (an update sets the XLAT interrupt itself)
+        set_XLAT_interrupt();
+    }
+}
+
+/* @} */
+
+#endif
+
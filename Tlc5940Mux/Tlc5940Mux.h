@@ -19,10 +19,19 @@
 #ifndef TLC5940MUX_H
 #define TLC5940MUX_H
 
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#endif
 #include <stdint.h>
 #include "tlcMux_config.h"
+
+#if !defined(TLC_HOST)
+/** Cycle estimate for the host register mock (pinouts/Host.h), nothing on a
+    real chip */
+#define tlc_host_cycles(cycles)
+#endif
+
 #include "tlcMux_shift8.h"
 
 /** Enables the output of XLAT pulses */
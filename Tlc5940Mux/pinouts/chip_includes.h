@@ -22,7 +22,9 @@
 /** \file
     Includes the chip-specfic defaults and pin definitions. */
 
+#if defined(__AVR__)
 #include <avr/io.h>
+#endif
 
 #ifndef PB0
 #define PB0     PORTB0
@@ -110,6 +112,11 @@
 /* Teensy++ 2.0 */
 #include "Teensypp_xxx6.h"
 
+#elif defined(TLC_HOST)
+
+/* Workstation build with the register mock */
+#include "Host.h"
+
 #else
 #error "Unknown Chip!"
 #endif
@@ -62,9 +62,11 @@ static void TlcMux_shift8_init(void)
 /** Shifts out a byte, MSB first */
 static void TlcMux_shift8(uint8_t byte)
 {
+    tlc_host_cycles(TLC_HOST_CALL_CYCLES);
     SPDR = byte; // starts transmission
     while (!(SPSR & _BV(SPIF)))
         ; // wait for transmission complete
+    tlc_host_cycles(TLC_HOST_RETURN_CYCLES);
 }
 
 #endif
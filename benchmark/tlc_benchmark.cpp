@@ -0,0 +1,441 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host benchmark of the Tlc5940 hot paths.  Build it with tlc5940_benchmark.sh
+    (it compiles this with -DTLC_HOST and the library's Tlc5940.cpp).
+
+    Tlc.set, Tlc.setRange, Tlc.get, tlc_isFading, tlc_retargetFade and
+    tlc_updateFades rows are a sweep over every channel (tlc_isFading,
+    tlc_retargetFade and tlc_updateFades with as many fades as fit in the
+    fade buffer).  tlc_decodeAnimationFrame decodes one compressed frame,
+    tlc_interpolateFrame blends every channel between two keyframes,
+    tlc_mergeTracks merges #TLC_NUM_TRACKS tracks on every channel,
+    tlc_streamFrame reads one frame from a byte stream into the stream FIFO
+    and shows it from the XLAT callback.
+
+    tlc_updateFades_step steps a full fade buffer by 1 ms without an update,
+    tlc_updateFades_divide does the same with the multiply and divide per
+    fade that tlc_updateFades() used before the fade pool (the divide done
+    in software, as on an AVR).  The fade rows ending in _compact are the
+    same with TLC_FADE_COMPACT 1. */
+
+#include "Tlc5940.h"
+#include "tlc_fades.h"
+#include "tlc_animations.h"
+#include "tlc_interpolation.h"
+#include "tlc_tracks.h"
+#include "tlc_stream.h"
+#include "tlc_progmem_utils.h"
+#include "tlc_shifts.h"
+#include "tlc_benchmark.h"
+
+#if TLC_FADE_COMPACT
+/** tlc5940_benchmark.sh builds the fade rows again with TLC_FADE_COMPACT 1,
+    only those are run */
+#define TLC_BENCH_FADE_ROW(name)    name "_compact"
+/** How long the benchmark fades last, compact fades end within 65535 ms */
+#define BENCH_FADE_MILLIS       60000
+/** When the fades of benchFadesPendingSetup() start and end */
+#define BENCH_PENDING_START     50000
+#define BENCH_PENDING_END       60000
+#else
+/** The name of a fade row */
+#define TLC_BENCH_FADE_ROW(name)    name
+/** How long the benchmark fades last */
+#define BENCH_FADE_MILLIS       1000000
+/** When the fades of benchFadesPendingSetup() start and end */
+#define BENCH_PENDING_START     2000000
+#define BENCH_PENDING_END       3000000
+#endif
+
+prog_uint8_t benchGSArray[NUM_TLCS * 24] PROGMEM;
+
+volatile uint16_t benchSink; // keeps Tlc.get() from being optimized out
+
+static void benchInit(void)
+{
+    Tlc.init();
+    tlc_host_pwmPeriod();
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        Tlc.set(channel, channel * 16);
+    }
+}
+
+static void benchUpdate(void)
+{
+    tlc_needXLAT = 0; // as if the XLAT interrupt had run
+    Tlc.update();
+}
+
+static void benchSet(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        Tlc.set(channel, 4095 - channel);
+    }
+}
+
+static uint16_t benchFrame[NUM_TLCS * 16];
+
+static void benchSetRange(void)
+{
+    Tlc.setRange(0, benchFrame, NUM_TLCS * 16);
+}
+
+static void benchGet(void)
+{
+    uint16_t sum = 0;
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        sum += Tlc.get(channel);
+    }
+    benchSink = sum;
+}
+
+static void benchSetAll(void)
+{
+    Tlc.setAll(2048);
+}
+
+static void benchShiftUp(void)
+{
+    benchSink = tlc_shiftUp(benchSink);
+}
+
+static void benchShiftDown(void)
+{
+    benchSink = tlc_shiftDown(benchSink);
+}
+
+static void benchFadesSetup(void)
+{
+    benchInit();
+    tlc_initFadePool(tlc_fadeBuffer, TLC_FADE_BUFFER_LENGTH);
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16
+            && channel < TLC_FADE_BUFFER_LENGTH; channel++) {
+        tlc_addFade(channel, 0, 4095, 0, BENCH_FADE_MILLIS);
+    }
+}
+
+static void benchUpdateFades(void)
+{
+    tlc_needXLAT = 0;
+    tlc_updateFades(BENCH_FADE_MILLIS / 2);
+}
+
+static uint32_t benchFadeMillis;
+
+static void benchFadeStepsSetup(void)
+{
+    benchFadesSetup();
+    benchFadeMillis = 0;
+}
+
+/** tlc_updateFades() without the update (tlc_needXLAT is set, so Tlc.update()
+    returns right away): the cost of stepping the fades one millisecond. */
+static void benchFadeSteps(void)
+{
+    if (++benchFadeMillis == BENCH_FADE_MILLIS) {
+        benchFadeStepsSetup();
+    }
+    tlc_needXLAT = 1;
+    tlc_updateFades(benchFadeMillis);
+}
+
+/** The fades of benchFadeStepsSetup() as the struct Tlc_Fade buffer that
+    tlc_updateFades() stepped before the fade pool */
+static struct Tlc_Fade benchDivideFades[TLC_FADE_BUFFER_LENGTH];
+static uint8_t benchDivideFadesSize;
+
+static void benchFadeDivideSetup(void)
+{
+    benchInit();
+    benchDivideFadesSize = 0;
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16
+            && channel < TLC_FADE_BUFFER_LENGTH; channel++) {
+        struct Tlc_Fade *p = benchDivideFades + benchDivideFadesSize++;
+        p->channel = channel;
+        p->startValue = 0;
+        p->changeValue = 4095;
+        p->startMillis = 0;
+        p->endMillis = BENCH_FADE_MILLIS;
+    }
+    benchFadeMillis = 0;
+}
+
+/** A signed 32 bit divide the way libgcc does it on an AVR (which has no
+    divide instruction): the magnitudes with 32 shift and subtract steps,
+    then the sign.  The host's hardware divide would hide what the old
+    tlc_updateFades() cost. */
+static int32_t benchDivide32(int32_t dividend, int32_t divisor)
+{
+    uint8_t negative = (dividend < 0) != (divisor < 0);
+    uint32_t n = dividend < 0 ? -(uint32_t)dividend : dividend;
+    uint32_t d = divisor < 0 ? -(uint32_t)divisor : divisor;
+    uint32_t remainder = 0;
+    for (uint8_t bit = 0; bit < 32; bit++) {
+        remainder = (remainder << 1) | (n >> 31);
+        n <<= 1;
+        if (remainder >= d) {
+            remainder -= d;
+            n |= 1;
+        }
+    }
+    return negative ? -(int32_t)n : (int32_t)n;
+}
+
+/** benchFadeSteps() the way tlc_updateFades() used to step a fade: a 32 bit
+    multiply and divide every step */
+static void benchFadeDivide(void)
+{
+    if (++benchFadeMillis == BENCH_FADE_MILLIS) {
+        benchFadeDivideSetup();
+    }
+    uint32_t currentMillis = benchFadeMillis;
+    struct Tlc_Fade *end = benchDivideFades + benchDivideFadesSize;
+    uint8_t needsUpdate = 0;
+    for (struct Tlc_Fade *p = benchDivideFades; p < end; p++) {
+        if (currentMillis >= p->endMillis) {
+            Tlc.set(p->channel, p->startValue + p->changeValue);
+            needsUpdate = 1;
+        } else if (currentMillis >= p->startMillis) {
+            Tlc.set(p->channel, p->startValue
+                    + benchDivide32(p->changeValue
+                                    * (int32_t)(currentMillis - p->startMillis),
+                                    p->endMillis - p->startMillis));
+            needsUpdate = 1;
+        }
+    }
+    if (needsUpdate) {
+        tlc_needXLAT = 1;
+        Tlc.update();
+    }
+}
+
+/** A full fade buffer of fades that start in the future */
+static void benchFadesPendingSetup(void)
+{
+    benchInit();
+    tlc_initFadePool(tlc_fadeBuffer, TLC_FADE_BUFFER_LENGTH);
+    for (uint16_t i = 0; i < TLC_FADE_BUFFER_LENGTH; i++) {
+        tlc_addFade(i % (NUM_TLCS * 16), 0, 4095, BENCH_PENDING_START + i,
+                    BENCH_PENDING_END);
+    }
+    benchFadeMillis = 0;
+}
+
+/** benchFadeSteps() with only fades that haven't started */
+static void benchFadesPending(void)
+{
+    if (++benchFadeMillis == BENCH_PENDING_START) {
+        benchFadesPendingSetup();
+    }
+    tlc_needXLAT = 1;
+    tlc_updateFades(benchFadeMillis);
+}
+
+static uint8_t benchGroupChannels[NUM_TLCS * 2];
+static struct Tlc_FadeGroup benchGroup = {benchGroupChannels, 0, 0};
+
+/** One group fade on every channel */
+static void benchFadeGroupSetup(void)
+{
+    benchInit();
+    tlc_initFadePool(tlc_fadeBuffer, TLC_FADE_BUFFER_LENGTH);
+    for (uint8_t i = 0; i < NUM_TLCS * 2; i++) {
+        benchGroupChannels[i] = 0xFF;
+    }
+    tlc_fadeGroups[0] = &benchGroup;
+    tlc_addGroupFade(0, 0, 4095, 0, BENCH_FADE_MILLIS);
+    benchFadeMillis = 0;
+}
+
+static void benchFadeGroup(void)
+{
+    if (++benchFadeMillis == BENCH_FADE_MILLIS) {
+        benchFadeGroupSetup();
+    }
+    tlc_needXLAT = 1;
+    tlc_updateFades(benchFadeMillis);
+}
+
+/** A running fade on every channel */
+static void benchRetargetSetup(void)
+{
+    benchFadesSetup();
+    tlc_needXLAT = 1;
+    tlc_updateFades(BENCH_FADE_MILLIS / 2);
+}
+
+static void benchRetarget(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16
+            && channel < TLC_FADE_BUFFER_LENGTH; channel++) {
+        tlc_retargetFade(channel, channel * 16, 100);
+    }
+}
+
+static void benchIsFading(void)
+{
+    uint16_t fading = 0;
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        fading += tlc_isFading(channel);
+    }
+    benchSink = fading;
+}
+
+/** The byte at a time loop Tlc.update() used before it was pipelined */
+static void benchShift8Loop(void)
+{
+    uint8_t *p = tlc_GSData;
+    while (p < tlc_GSData + NUM_TLCS * 24) {
+        tlc_shift8(*p++);
+    }
+}
+
+static void benchSetGSfromProgmem(void)
+{
+    tlc_setGSfromProgmem(benchGSArray);
+}
+
+/** One compressed frame: a third each of zero, literal and repeated runs */
+static uint8_t benchAnimation[NUM_TLCS * 16];
+
+static void benchAnimationSetup(void)
+{
+    benchInit();
+    uint8_t *p = benchAnimation;
+    for (uint8_t i = 0; i < NUM_TLCS; i++) {
+        *p++ = TLC_ANI_ZERO | 7;
+        *p++ = TLC_ANI_COPY | 7;
+        for (uint8_t j = 0; j < 8; j++) {
+            *p++ = i + j;
+        }
+        *p++ = TLC_ANI_REPEAT | 7;
+    }
+}
+
+static void benchDecodeAnimationFrame(void)
+{
+    tlc_currentAnimation = tlc_animationAddress(benchAnimation);
+    tlc_decodeAnimationFrame();
+}
+
+/** A blend from the current values to their inverse */
+static void benchInterpolateSetup(void)
+{
+    benchInit();
+    for (uint16_t i = 0; i < NUM_TLCS * 16; i++) {
+        tlc_interpolationStart[i] = i * 16;
+        tlc_interpolationDelta[i] = 4095 - i * 32;
+    }
+}
+
+static void benchInterpolateFrame(void)
+{
+    tlc_interpolateFrame(benchSink++ & 4095);
+}
+
+static uint8_t benchTrackChannels[NUM_TLCS * 2];
+static struct Tlc_Track benchTracks[TLC_NUM_TRACKS];
+
+/** Every track plays benchGSArray on every channel, one of each blend */
+static void benchTracksSetup(void)
+{
+    benchInit();
+    for (uint8_t i = 0; i < NUM_TLCS * 2; i++) {
+        benchTrackChannels[i] = 0xFF;
+    }
+    for (uint8_t i = 0; i < TLC_NUM_TRACKS; i++) {
+        struct Tlc_Track *track = benchTracks + i;
+        track->animation = tlc_animationAddress(benchGSArray);
+        track->frames = 1;
+        track->channels = benchTrackChannels;
+        track->blend = i % 3;
+        tlc_setTrack(i, track);
+        track->frame = 0;
+    }
+}
+
+static void benchMergeTracks(void)
+{
+    tlc_mergeTracks();
+}
+
+static struct Tlc_StreamSource benchStream;
+
+/** A byte stream that always has the bytes of benchGSArray */
+static int16_t benchStreamRead(uint8_t *buffer, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        buffer[i] = benchGSArray[i];
+    }
+    return count;
+}
+
+/** A stream with a full FIFO, as fast as the frames come */
+static void benchStreamSetup(void)
+{
+    benchInit();
+    tlc_initStreamSource(&benchStream, benchStreamRead);
+    tlc_playStream(&benchStream.source, 0);
+}
+
+static void benchStreamFrame(void)
+{
+    tlc_needXLAT = 0; // as if the XLAT interrupt had run
+    tlc_streamXLATCallback();
+    tlc_streamFill();
+}
+
+int main(void)
+{
+#if !TLC_FADE_COMPACT
+    tlc_bench_header();
+    tlc_bench("Tlc.update", benchInit, benchUpdate);
+    tlc_bench("Tlc.set", benchInit, benchSet);
+    tlc_bench("Tlc.setRange", benchInit, benchSetRange);
+    tlc_bench("Tlc.get", benchInit, benchGet);
+    tlc_bench("Tlc.setAll", benchInit, benchSetAll);
+    tlc_bench("tlc_shiftUp", benchInit, benchShiftUp);
+    tlc_bench("tlc_shiftDown", benchInit, benchShiftDown);
+    tlc_bench("tlc_updateFades_divide", benchFadeDivideSetup, benchFadeDivide);
+#endif
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_updateFades"), benchFadesSetup,
+              benchUpdateFades);
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_updateFades_step"), benchFadeStepsSetup,
+              benchFadeSteps);
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_updateFades_pending"),
+              benchFadesPendingSetup, benchFadesPending);
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_updateFades_group"), benchFadeGroupSetup,
+              benchFadeGroup);
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_retargetFade"), benchRetargetSetup,
+              benchRetarget);
+    tlc_bench(TLC_BENCH_FADE_ROW("tlc_isFading"), benchFadesPendingSetup,
+              benchIsFading);
+#if !TLC_FADE_COMPACT
+    tlc_bench("tlc_setGSfromProgmem", benchInit, benchSetGSfromProgmem);
+    tlc_bench("tlc_decodeAnimationFrame", benchAnimationSetup,
+              benchDecodeAnimationFrame);
+    tlc_bench("tlc_interpolateFrame", benchInterpolateSetup,
+              benchInterpolateFrame);
+    tlc_bench("tlc_mergeTracks", benchTracksSetup, benchMergeTracks);
+    tlc_bench("tlc_shift8_loop", benchInit, benchShift8Loop);
+    tlc_bench("tlc_streamFrame", benchStreamSetup, benchStreamFrame);
+#endif
+    return 0;
+}
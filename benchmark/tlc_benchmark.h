@@ -0,0 +1,154 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_BENCHMARK_H
+#define TLC_BENCHMARK_H
+
+/** \file
+    Shared code for the host benchmarks (see tlc5940_benchmark.sh).  Include
+    this after the library headers: it needs tlc_host() from pinouts/Host.h.
+
+    Every benchmark prints one row:
+    - io_ops: register reads + writes for one call
+    - spi_bytes: bytes written to SPDR for one call
+    - sclk: SCLK pulses the TLCs saw for one call
+    - est_cycles: estimated AVR cycles spent on i/o, SPI waits and interrupts
+      for one call (plain ram and arithmetic work isn't counted)
+    - host_ns: cpu nanoseconds per call on this machine (includes the mock,
+      only comparable between runs on the same machine).  This is the only
+      column that sees ram and arithmetic work, so the script fails on it
+      too.
+    - ref_ns: host_ns of tlc_bench_reference(), timed between the batches of
+      the benchmark.  The script compares host_ns / ref_ns, which doesn't
+      change when the whole machine gets faster or slower. */
+
+#include <stdio.h>
+#include <time.h>
+
+#define TLC_BENCH_STR2(x)    #x
+#define TLC_BENCH_STR(x)     TLC_BENCH_STR2(x)
+
+#if DATA_TRANSFER_MODE == TLC_BITBANG
+#define TLC_BENCH_MODE    "bitbang"
+#elif DATA_TRANSFER_MODE == TLC_USART_SPI
+#define TLC_BENCH_MODE    "usart"
+#elif DATA_TRANSFER_MODE == TLC_PARALLEL_BITBANG
+#define TLC_BENCH_MODE    "pbb" TLC_BENCH_STR(TLC_NUM_CHAINS)
+#else
+#define TLC_BENCH_MODE    "spi"
+#endif
+
+/** Each host_ns measurement runs for at least this long. */
+#define TLC_BENCH_MIN_NS    50000000ULL
+/** The shortest batch of calls that host_ns times */
+#define TLC_BENCH_BATCH_NS  200000ULL
+
+static uint64_t tlc_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** A fixed amount of ram and arithmetic work that host_ns is compared to */
+static void tlc_bench_reference(void)
+{
+    static volatile uint16_t work[64];
+    for (uint8_t i = 0; i < 64; i++) {
+        work[i] = work[(i * 7) & 63] * 3 + i;
+    }
+}
+
+/** \returns the time in ns that calls calls of run take */
+static uint64_t tlc_bench_batch(void (*run)(void), uint32_t calls)
+{
+    uint64_t start = tlc_bench_now();
+    for (uint32_t i = 0; i < calls; i++) {
+        run();
+    }
+    return tlc_bench_now() - start;
+}
+
+/** \returns how many calls of run make a batch of TLC_BENCH_BATCH_NS */
+static uint32_t tlc_bench_calls(void (*run)(void))
+{
+    uint32_t calls = 1;
+    while (tlc_bench_batch(run, calls) < TLC_BENCH_BATCH_NS) {
+        calls *= 2;
+    }
+    return calls;
+}
+
+/** Prints the column names. */
+static void tlc_bench_header(void)
+{
+    printf("#%-30s %5s %-8s %8s %9s %8s %10s %10s %7s\n", "function",
+           "tlcs", "mode", "io_ops", "spi_bytes", "sclk", "est_cycles",
+           "host_ns", "ref_ns");
+}
+
+/** Runs a benchmark and prints its row.
+    \param name what's being measured (no spaces)
+    \param setup called once before anything is measured (can be 0)
+    \param run one call of the hot path.  It has to leave things so it can be
+           called again. */
+static void tlc_bench(const char *name, void (*setup)(void), void (*run)(void))
+{
+    if (setup) {
+        setup();
+    }
+    run(); // warm up
+    tlc_host_runSPI();
+    tlc_host_resetStats();
+    run();
+    tlc_host_runSPI();
+    TlcHostStats stats = tlc_host().stats;
+
+    /* the clock is only read around a batch of calls that takes at least
+       TLC_BENCH_BATCH_NS, so reading it doesn't count.  The batches take
+       turns with batches of tlc_bench_reference(), and the best of each is
+       taken: a slower batch was interrupted. */
+    uint32_t calls = tlc_bench_calls(run);
+    uint32_t refCalls = tlc_bench_calls(tlc_bench_reference);
+    uint64_t bestNs = ~0ULL;
+    uint64_t bestRefNs = ~0ULL;
+    uint64_t total = 0;
+    while (total < TLC_BENCH_MIN_NS) {
+        uint64_t ns = tlc_bench_batch(run, calls);
+        uint64_t refNs = tlc_bench_batch(tlc_bench_reference, refCalls);
+        if (ns < bestNs) {
+            bestNs = ns;
+        }
+        if (refNs < bestRefNs) {
+            bestRefNs = refNs;
+        }
+        total += ns + refNs;
+    }
+    bestNs /= calls;
+    bestRefNs /= refCalls;
+
+    printf("%-31s %5u %-8s %8lu %9lu %8lu %10llu %10llu %7llu\n", name,
+           (unsigned)NUM_TLCS, TLC_BENCH_MODE,
+           (unsigned long)(stats.reads + stats.writes),
+           (unsigned long)stats.spiBytes, (unsigned long)stats.sclkPulses,
+           (unsigned long long)stats.cpuCycles, (unsigned long long)bestNs,
+           (unsigned long long)bestRefNs);
+}
+
+#endif
+
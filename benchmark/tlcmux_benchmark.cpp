@@ -0,0 +1,48 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host benchmark of TlcMux_shiftRow().  Build it with tlc5940_benchmark.sh
+    (it compiles this with -DTLC_HOST against the Tlc5940Mux folder). */
+
+#include "Tlc5940Mux.h"
+#include "tlc_benchmark.h"
+
+ISR(TIMER1_OVF_vect)
+{
+}
+
+static void benchInit(void)
+{
+    TlcMux_init();
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        TlcMux_set(0, channel, channel * 16);
+    }
+}
+
+static void benchShiftRow(void)
+{
+    TlcMux_shiftRow(0);
+}
+
+int main(void)
+{
+    tlc_bench("TlcMux_shiftRow", benchInit, benchShiftRow);
+    return 0;
+}
+
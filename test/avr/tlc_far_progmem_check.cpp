@@ -0,0 +1,134 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    ATmega2560 check of the ELPM loops in tlc_progmem_utils.h
+    (TLC_FAR_PROGMEM), built and run by tlc5940_avr_check.sh.  An array that
+    starts just below the 64 KB boundary and ends past it is read with
+    tlc_setGSfromFarProgmem() and tlc_copyFromFarProgmem() at every offset
+    and compared with pgm_read_byte_far().  The result is printed on UART0
+    (simavr shows it) and the cpu sleeps with interrupts off, which ends a
+    simavr run. */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include "Tlc5940.h"
+#include "tlc_progmem_utils.h"
+
+/** Bytes of the array, about half of them past the 64 KB boundary */
+#define CHECK_BYTES    512
+
+/* Built with -fdata-sections -fno-toplevel-reorder, so these are placed in
+   order after the 228 bytes of vectors: farData[] starts 256 bytes below
+   64 KB. */
+__attribute__((used)) const uint8_t pad0[32526] PROGMEM = {1};
+__attribute__((used)) const uint8_t pad1[32526] PROGMEM = {2};
+const uint8_t farData[CHECK_BYTES] PROGMEM = {
+#define B(i)     (uint8_t)((i) * 7 + (i) / 256 + 3)
+#define B8(i)    B(i), B(i + 1), B(i + 2), B(i + 3), \
+                 B(i + 4), B(i + 5), B(i + 6), B(i + 7)
+#define B64(i)   B8(i), B8(i + 8), B8(i + 16), B8(i + 24), \
+                 B8(i + 32), B8(i + 40), B8(i + 48), B8(i + 56)
+    B64(0), B64(64), B64(128), B64(192),
+    B64(256), B64(320), B64(384), B64(448)
+};
+
+static uint16_t failures;
+
+static void print(const char *s)
+{
+    while (*s) {
+        while (!(UCSR0A & _BV(UDRE0)))
+            ;
+        UDR0 = *s++;
+    }
+}
+
+static void printHex(uint32_t value)
+{
+    char s[9];
+    for (int8_t i = 7; i >= 0; i--) {
+        s[i] = "0123456789abcdef"[value & 15];
+        value >>= 4;
+    }
+    s[8] = 0;
+    print(s);
+}
+
+static void fail(const char *what, uint32_t address)
+{
+    if (failures++ < 10) {
+        print("FAILED ");
+        print(what);
+        print(" at 0x");
+        printHex(address);
+        print("\n");
+    }
+}
+
+int main(void)
+{
+    UBRR0 = 8; // 115200 baud at 16 MHz
+    UCSR0B = _BV(TXEN0);
+    uint_farptr_t far = pgm_get_far_address(farData);
+    if (far >= 0x10000UL || far + CHECK_BYTES <= 0x10000UL) {
+        fail("farData doesn't cross 64 KB", far);
+    }
+
+    // every offset, so the boundary falls on each byte of a GS_DUO
+    for (uint16_t offset = 0; offset + NUM_TLCS * 24 <= CHECK_BYTES;
+            offset++) {
+        tlc_setGSfromFarProgmem(far + offset);
+        for (uint16_t i = 0; i < NUM_TLCS * 24; i++) {
+            if (tlc_GSData[i] != pgm_read_byte_far(far + offset + i)) {
+                fail("tlc_setGSfromFarProgmem", far + offset + i);
+            }
+        }
+    }
+    static uint8_t copy[256];
+    for (uint16_t offset = 0; offset <= CHECK_BYTES - 255; offset += 7) {
+        uint8_t count = offset % 255 + 1;
+        copy[count] = 0xA5; // one past the end, mustn't be written
+        tlc_copyFromFarProgmem(copy, far + offset, count);
+        for (uint8_t i = 0; i < count; i++) {
+            if (copy[i] != pgm_read_byte_far(far + offset + i)) {
+                fail("tlc_copyFromFarProgmem", far + offset + i);
+            }
+        }
+        if (copy[count] != 0xA5) {
+            fail("tlc_copyFromFarProgmem past the end", far + offset);
+        }
+    }
+    // (pgm_read_byte_far() leaves RAMPZ set)
+    RAMPZ = 0;
+    tlc_setGSfromFarProgmem(far + CHECK_BYTES - NUM_TLCS * 24);
+    tlc_copyFromFarProgmem(copy, far + CHECK_BYTES - 16, 16);
+    if (RAMPZ != 0) {
+        fail("RAMPZ not restored", RAMPZ);
+    }
+
+    print(failures? "tlc_far_progmem_check: FAILED\n"
+                   : "tlc_far_progmem_check: ok\n");
+    cli();
+    sleep_enable();
+    sleep_cpu();
+    for (;;)
+        ;
+}
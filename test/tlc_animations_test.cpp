@@ -0,0 +1,174 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_animations.h: an animation of zero, constant, unchanged
+    and random runs of channels is played raw with tlc_playAnimation() and
+    compressed (with random runs of every op, like
+    tlc_encode_animation.py makes) with tlc_playCompressedAnimation().  Both
+    have to show every frame, in order, for the right number of periods. */
+
+#include <string.h>
+#include "Tlc5940.h"
+#include "tlc_animations.h"
+#include "tlc_test.h"
+
+/** The frames in the test animation */
+#define TEST_FRAMES         30
+/** Bytes in a frame */
+#define TEST_FRAME_BYTES    (NUM_TLCS * 24)
+/** PWM periods each frame waits after the one it's shown in */
+#define TEST_PERIODS        2
+
+/** The frames in playing order */
+static uint8_t frames[TEST_FRAMES][TEST_FRAME_BYTES];
+/** The frames last first, for tlc_playAnimation() */
+static uint8_t raw[TEST_FRAMES * TEST_FRAME_BYTES];
+/** The compressed animation, at worst every byte is a 1 byte copy */
+static uint8_t compressed[TLC_ANI_HEADER_BYTES
+                          + TEST_FRAMES * TEST_FRAME_BYTES * 2];
+
+static void makeFrames(void)
+{
+    static uint16_t values[NUM_TLCS * 16];
+    for (uint16_t frame = 0; frame < TEST_FRAMES; frame++) {
+        uint16_t channel = 0;
+        while (channel < NUM_TLCS * 16) {
+            uint16_t end = channel + 1 + tlc_test_random() % 24;
+            if (end > NUM_TLCS * 16) {
+                end = NUM_TLCS * 16;
+            }
+            uint8_t kind = tlc_test_random() % 4;
+            uint16_t value = tlc_test_random() & 4095;
+            for (; channel < end; channel++) {
+                if (kind == 0) {
+                    values[channel] = 0;
+                } else if (kind == 1) {
+                    values[channel] = value;
+                } else if (kind == 3 || !frame) { // 2 leaves it unchanged
+                    values[channel] = tlc_test_random() & 4095;
+                }
+            }
+        }
+        for (channel = 0; channel < NUM_TLCS * 16; channel++) {
+            tlc_setPacked(frames[frame], NUM_TLCS * 16 - 1 - channel,
+                          values[channel]);
+        }
+        memcpy(raw + (TEST_FRAMES - 1 - frame) * TEST_FRAME_BYTES,
+               frames[frame], TEST_FRAME_BYTES);
+    }
+}
+
+/** \returns the longest run (up to 64) at i that op can encode */
+static uint8_t longestRun(uint8_t op, const uint8_t *frame,
+                          const uint8_t *last, uint16_t i)
+{
+    uint8_t length = 0;
+    while (length < 64 && i + length < TEST_FRAME_BYTES) {
+        uint8_t byte = frame[i + length];
+        if ((op == TLC_ANI_SKIP && (!last || byte != last[i + length]))
+                || (op == TLC_ANI_REPEAT
+                    && (i + length < 3 || byte != frame[i + length - 3]))
+                || (op == TLC_ANI_ZERO && byte)) {
+            break;
+        }
+        length++;
+    }
+    return length;
+}
+
+/** Encodes a frame into out with random runs of every op that fits.
+    \param last the frame before, 0 for a keyframe
+    \returns the end of the frame's ops */
+static uint8_t *encodeFrame(uint8_t *out, const uint8_t *frame,
+                            const uint8_t *last)
+{
+    uint16_t i = 0;
+    while (i < TEST_FRAME_BYTES) {
+        uint8_t op = (tlc_test_random() % 4) << 6;
+        uint8_t length = longestRun(op, frame, last, i);
+        if (!length) {
+            op = TLC_ANI_COPY;
+            length = longestRun(op, frame, last, i);
+        }
+        length = 1 + tlc_test_random() % length;
+        *out++ = op | (length - 1);
+        if (op == TLC_ANI_COPY) {
+            memcpy(out, frame + i, length);
+            out += length;
+        }
+        i += length;
+    }
+    return out;
+}
+
+/** Compresses the frames into compressed[]
+    \param keyframes a keyframe every this many frames (0: only the first) */
+static void compress(uint16_t keyframes)
+{
+    uint8_t *out = compressed;
+    *out++ = (uint8_t)TEST_FRAMES;
+    *out++ = TEST_FRAMES >> 8;
+    *out++ = (uint8_t)TEST_FRAME_BYTES;
+    *out++ = TEST_FRAME_BYTES >> 8;
+    for (uint16_t frame = 0; frame < TEST_FRAMES; frame++) {
+        uint8_t keyframe = frame == 0 || (keyframes && frame % keyframes == 0);
+        out = encodeFrame(out, frames[frame],
+                          keyframe? 0 : frames[frame - 1]);
+    }
+}
+
+/** Checks that the playing animation shows every frame for
+    TEST_PERIODS + 1 periods and then ends */
+static void checkPlaying(void)
+{
+    for (uint16_t frame = 0; frame < TEST_FRAMES; frame++) {
+        TLC_CHECK(tlc_onUpdateFinished);
+        TLC_CHECK(!memcmp(tlc_GSData, frames[frame], TEST_FRAME_BYTES));
+        tlc_host_pwmPeriod(); // latches it
+        for (uint8_t period = 0; period < TEST_PERIODS; period++) {
+            TLC_CHECK(tlc_test_showing());
+            tlc_host_pwmPeriod(); // the last one starts the next frame
+        }
+    }
+    TLC_CHECK(!tlc_onUpdateFinished);
+}
+
+int main(void)
+{
+    makeFrames();
+    Tlc.init();
+    tlc_host_pwmPeriod();
+
+    tlc_playAnimation(raw, TEST_FRAMES, TEST_PERIODS);
+    checkPlaying();
+
+    compress(0);
+    TLC_CHECK(tlc_playCompressedAnimation(compressed, TEST_PERIODS) == 1);
+    checkPlaying();
+
+    compress(7);
+    TLC_CHECK(tlc_playCompressedAnimation(compressed, TEST_PERIODS) == 1);
+    checkPlaying();
+
+    // made for a different NUM_TLCS
+    compressed[2]++;
+    TLC_CHECK(tlc_playCompressedAnimation(compressed, TEST_PERIODS) == 0);
+    TLC_CHECK(!tlc_onUpdateFinished);
+    return tlc_test_done();
+}
@@ -0,0 +1,125 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_chain.h: a Tlc5940Chain bit-banged on the model's extra
+    chain pins (TLC_HOST_EXTRA_SIN_PIN, TLC_HOST_EXTRA_SCLK_PIN) has to show
+    what it was set to, latch on the same XLAT as Tlc without waiting for it
+    inside init() and leave Tlc's TLCs alone. */
+
+#include "Tlc5940.h"
+#include "tlc_chain.h"
+#include "tlc_test.h"
+
+TLC_CHAIN_PIN(TestSin, TLC_HOST_EXTRA_PORT, TLC_HOST_EXTRA_DDR,
+              TLC_HOST_EXTRA_SIN_PIN);
+TLC_CHAIN_PIN(TestSclk, TLC_HOST_EXTRA_PORT, TLC_HOST_EXTRA_DDR,
+              TLC_HOST_EXTRA_SCLK_PIN);
+
+typedef Tlc5940Chain<TLC_HOST_CHAIN_TLCS, TlcBitBang<TestSin, TestSclk> >
+        TestChain;
+static TestChain chain;
+
+/** What each channel of the chain should hold */
+static uint16_t expected[TestChain::numChannels];
+
+/** \returns 1 if the chain's TLCs show expected[] and get() reads it back */
+static uint8_t chainShowing(void)
+{
+    for (uint16_t channel = 0; channel < TestChain::numChannels; channel++) {
+        if (chain.get(channel) != expected[channel]
+                || tlc_host_getExtraGS(channel) != expected[channel]) {
+            printf("  chain channel %u: showing %u, get() %u, expected %u\n",
+                   (unsigned)channel, (unsigned)tlc_host_getExtraGS(channel),
+                   (unsigned)chain.get(channel), (unsigned)expected[channel]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** The chain waits for the XLAT of an update of Tlc, then shifts in */
+static void testSharedXLAT(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        Tlc.set(channel, tlc_test_random() & 4095);
+    }
+    for (uint16_t channel = 0; channel < TestChain::numChannels; channel++) {
+        expected[channel] = tlc_test_random() & 4095;
+        chain.set(channel, expected[channel]);
+    }
+    tlc_present();
+    TLC_CHECK(chain.update() == 1);
+    uint8_t periods = 0;
+    while (chain.update() && periods++ < 4) {
+        tlc_host_pwmPeriod();
+    }
+    TLC_CHECK(periods <= 2);
+    tlc_host_pwmPeriod();
+    TLC_CHECK(chainShowing());
+    TLC_CHECK(tlc_test_showing());
+}
+
+int main(void)
+{
+    Tlc.init(1000);
+    tlc_host_pwmPeriod();
+    TLC_CHECK(chain.init(77) == 0);
+    tlc_host_pwmPeriod();
+    for (uint16_t channel = 0; channel < TestChain::numChannels; channel++) {
+        expected[channel] = 77;
+    }
+    TLC_CHECK(chainShowing());
+    TLC_CHECK(tlc_test_showing());
+
+    // init() while the XLAT is busy doesn't wait, update() sends it later
+    chain.clear();
+    TLC_CHECK(chain.update() == 0);
+    TLC_CHECK(chain.init(3000) == 1);
+    tlc_host_pwmPeriod();
+    TLC_CHECK(chain.update() == 0);
+    tlc_host_pwmPeriod();
+    for (uint16_t channel = 0; channel < TestChain::numChannels; channel++) {
+        expected[channel] = 3000;
+    }
+    TLC_CHECK(chainShowing());
+
+    for (uint8_t i = 0; i < 5; i++) {
+        testSharedXLAT();
+    }
+
+    // the last channel is the first one shifted out
+    chain.set(TestChain::numChannels - 1, 4095);
+    expected[TestChain::numChannels - 1] = 4095;
+    while (chain.update()) {
+        tlc_host_pwmPeriod();
+    }
+    tlc_host_pwmPeriod();
+    TLC_CHECK(chainShowing());
+
+#if TLC_DIRTY_TRACKING
+    uint32_t skipped = chain.skippedUpdates;
+    tlc_host_resetStats();
+    chain.set(0, expected[0]); // no change
+    TLC_CHECK(chain.update() == 0);
+    TLC_CHECK(chain.skippedUpdates == skipped + 1);
+    TLC_CHECK(tlc_host().stats.sclkPulses == 0);
+    TLC_CHECK(!tlc_needXLAT);
+#endif
+    return tlc_test_done();
+}
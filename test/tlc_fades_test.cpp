@@ -0,0 +1,282 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_fades.h: random tlc_addFade(), tlc_cancelFade(),
+    tlc_removeFades() and tlc_retargetFade() calls against a list of the
+    fades that should be in the pool.  After every call the running, waiting
+    and per channel lists have to hold exactly those fades, and a fade that
+    ends has to leave its channel at its end value. */
+
+#include "Tlc5940.h"
+#include "tlc_fades.h"
+#include "tlc_test.h"
+
+/** The channels the random fades go on */
+#define TEST_CHANNELS    8
+/** The length of the fade pool */
+#define TEST_POOL        6
+
+static struct Tlc_FadeState arena[TEST_POOL];
+
+/** A fade that should be in the pool */
+struct TestFade {
+    uint16_t handle;
+    uint8_t channel;
+    uint32_t start;
+    uint32_t end;
+    int16_t endValue;
+    uint32_t added;  /**< order of tlc_addFade() calls */
+    uint8_t running; /**< a step has started it */
+};
+
+static struct TestFade fades[TEST_POOL];
+static uint8_t numFades;
+static uint32_t numAdded;
+static uint32_t now;
+
+static void forget(uint8_t i)
+{
+    fades[i] = fades[--numFades];
+}
+
+/** Steps the fades to time, like tlc_updateFades(), and latches the frame.
+    tlc_updateFades() itself would wait for the XLAT after the last fade. */
+static void stepTo(uint32_t time)
+{
+    now = time;
+    tlc_host().millis = time;
+    if (tlc_stepFades(time)) {
+        tlc_present();
+    }
+    tlc_test_latch();
+}
+
+/** \returns the number of fades on a list, following next or channelNext */
+static uint8_t listLength(uint8_t n, uint8_t channelList)
+{
+    uint8_t length = 0;
+    while (n && length <= TEST_POOL) {
+        length++;
+        n = channelList? tlc_fadeAt(n)->channelNext : tlc_fadeAt(n)->next;
+    }
+    return length;
+}
+
+/** Checks the pool against fades[] */
+static void checkPool(void)
+{
+    uint8_t running = 0;
+    for (uint8_t n = tlc_fadeActive; n && running <= TEST_POOL;
+            n = tlc_fadeAt(n)->next) {
+        TLC_CHECK(tlc_fadeAt(n)->state & TLC_FADE_RUNNING);
+        running++;
+    }
+    TLC_CHECK(running == tlc_fadeActiveSize);
+    TLC_CHECK(running + listLength(tlc_fadePending, 0) == numFades);
+    TLC_CHECK(tlc_fadeBufferSize == numFades);
+    for (uint8_t channel = 0; channel < TEST_CHANNELS; channel++) {
+        uint8_t onChannel = 0;
+        for (uint8_t i = 0; i < numFades; i++) {
+            onChannel += fades[i].channel == channel;
+        }
+        TLC_CHECK(tlc_isFading(channel) == (onChannel != 0));
+        TLC_CHECK(listLength(tlc_channelFades[channel], 1) == onChannel);
+        for (uint8_t n = tlc_channelFades[channel]; n;
+                n = tlc_fadeAt(n)->channelNext) {
+            TLC_CHECK(tlc_fadeAt(n)->channel == channel);
+        }
+    }
+    for (uint8_t i = 0; i < numFades; i++) {
+        TLC_CHECK(tlc_fadeOfHandle(fades[i].handle) != 0);
+    }
+}
+
+static void testRandom(void)
+{
+    static uint16_t oldHandles[16];
+    Tlc.init();
+    tlc_initFadePool(arena, TEST_POOL);
+    stepTo(1000);
+    for (uint16_t round = 0; round < 20000; round++) {
+        uint8_t channel = tlc_test_random() % TEST_CHANNELS;
+        uint16_t r = tlc_test_random();
+        switch (r % 8) {
+            case 0:
+            case 1: { // add
+                uint32_t start = now + tlc_test_random() % 20;
+                uint32_t end = start + tlc_test_random() % 30;
+                int16_t endValue = tlc_test_random() & 4095;
+                uint16_t handle = tlc_addFade(channel, tlc_test_random() & 4095,
+                                              endValue, start, end,
+                                              r & 8? TLC_CURVE_EASE_IN
+                                                   : TLC_CURVE_LINEAR);
+                TLC_CHECK((handle != 0) == (numFades < TEST_POOL));
+                if (handle) {
+                    struct TestFade fade = {handle, channel, start, end,
+                                            endValue, numAdded++, 0};
+                    fades[numFades++] = fade;
+                    oldHandles[round & 15] = handle;
+                }
+                break;
+            }
+            case 2: { // cancel a fade, or a handle that may have ended
+                if (numFades && (r & 8)) {
+                    uint8_t i = tlc_test_random() % numFades;
+                    TLC_CHECK(tlc_cancelFade(fades[i].handle) == 1);
+                    forget(i);
+                } else {
+                    uint16_t handle = oldHandles[tlc_test_random() & 15];
+                    uint8_t live = 0;
+                    for (uint8_t i = 0; i < numFades; i++) {
+                        if (fades[i].handle == handle) {
+                            live = 1;
+                            forget(i);
+                            break;
+                        }
+                    }
+                    TLC_CHECK(tlc_cancelFade(handle) == live);
+                }
+                break;
+            }
+            case 3: { // remove every fade on a channel
+                uint8_t removed = 0;
+                for (uint8_t i = numFades; i--;) {
+                    if (fades[i].channel == channel) {
+                        removed++;
+                        forget(i);
+                    }
+                }
+                TLC_CHECK(tlc_removeFades(channel) == removed);
+                break;
+            }
+            case 4: { // retarget the running fade that was added first
+                int8_t first = -1;
+                for (uint8_t i = 0; i < numFades; i++) {
+                    if (fades[i].channel == channel && fades[i].running
+                            && (first < 0
+                                || fades[i].added < fades[first].added)) {
+                        first = i;
+                    }
+                }
+                int16_t endValue = tlc_test_random() & 4095;
+                uint32_t duration = tlc_test_random() % 30;
+                uint16_t handle = tlc_retargetFade(channel, endValue, duration);
+                if (first >= 0) {
+                    TLC_CHECK(handle == fades[first].handle);
+                    fades[first].end = now + duration;
+                    fades[first].endValue = endValue;
+                } else {
+                    TLC_CHECK((handle != 0) == (numFades < TEST_POOL));
+                    if (handle) {
+                        struct TestFade fade = {handle, channel, now,
+                                                now + duration, endValue,
+                                                numAdded++, 0};
+                        fades[numFades++] = fade;
+                    }
+                }
+                break;
+            }
+            default: { // time passes
+                uint32_t time = now + tlc_test_random() % 5;
+                uint8_t onChannel[TEST_CHANNELS] = {0};
+                for (uint8_t i = 0; i < numFades; i++) {
+                    onChannel[fades[i].channel]++;
+                }
+                stepTo(time);
+                for (uint8_t i = numFades; i--;) {
+                    if (tlc_timeReached(time, fades[i].end)) {
+                        if (onChannel[fades[i].channel] == 1) {
+                            TLC_CHECK(tlc_host_getGS(fades[i].channel)
+                                      == (uint16_t)fades[i].endValue);
+                        }
+                        forget(i);
+                    } else if (tlc_timeReached(time, fades[i].start)) {
+                        fades[i].running = 1;
+                    }
+                }
+                break;
+            }
+        }
+        checkPool();
+    }
+}
+
+/** A full pool with TLC_FADE_DROP_OLDEST and TLC_FADE_MERGE */
+static void testOverflow(void)
+{
+    uint16_t handles[TEST_POOL];
+    Tlc.init();
+    tlc_initFadePool(arena, TEST_POOL, TLC_FADE_DROP_OLDEST);
+    stepTo(100);
+    for (uint8_t i = 0; i < TEST_POOL; i++) {
+        handles[i] = tlc_addFade(i, 0, 4095, 100 + i, 200);
+    }
+    stepTo(102); // fades 0 - 2 are running
+    TLC_CHECK(tlc_addFade(TEST_POOL, 0, 4095, 150, 300) != 0);
+    TLC_CHECK(!tlc_isFading(0) && tlc_isFading(TEST_POOL));
+    TLC_CHECK(tlc_cancelFade(handles[0]) == 0);
+    TLC_CHECK(tlc_cancelFade(handles[1]) == 1);
+
+    tlc_initFadePool(arena, TEST_POOL, TLC_FADE_MERGE);
+    for (uint8_t i = 0; i < TEST_POOL; i++) {
+        handles[i] = tlc_addFade(i, 0, 4095, 100 + i, 200);
+    }
+    TLC_CHECK(tlc_addFade(TEST_POOL, 0, 4095, 100, 110) == 0);
+    TLC_CHECK(tlc_addFade(3, 4095, 7, 102, 110) != 0);
+    TLC_CHECK(tlc_cancelFade(handles[3]) == 0);
+    stepTo(110);
+    TLC_CHECK(tlc_host_getGS(3) == 7 && !tlc_isFading(3));
+}
+
+/** A linear fade has to be within 1 of the exact line at every step */
+static void testLinear(void)
+{
+    Tlc.init();
+    for (uint8_t round = 0; round < 100; round++) {
+        tlc_initFadePool(arena, TEST_POOL);
+        stepTo(0);
+        int32_t startValue = tlc_test_random() & 4095;
+        int32_t endValue = tlc_test_random() & 4095;
+        uint32_t start = 10 + tlc_test_random() % 10;
+        uint32_t duration = 1 + tlc_test_random() % (round & 1? 100 : 5000);
+        tlc_addFade(5, startValue, endValue, start, start + duration);
+        while (tlc_fadeBufferSize) {
+            stepTo(now + (round & 2? 1 : 1 + tlc_test_random() % 7));
+            if (!tlc_timeReached(now, start)) {
+                continue;
+            }
+            int32_t want = endValue;
+            if (!tlc_timeReached(now, start + duration)) {
+                want = startValue + (endValue - startValue)
+                       * (int32_t)(now - start) / (int32_t)duration;
+            }
+            int32_t diff = (int32_t)tlc_host_getGS(5) - want;
+            TLC_CHECK(diff >= -1 && diff <= 1);
+        }
+        TLC_CHECK(tlc_host_getGS(5) == endValue);
+    }
+}
+
+int main(void)
+{
+    testRandom();
+    testOverflow();
+    testLinear();
+    return tlc_test_done();
+}
@@ -0,0 +1,343 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of the core functions against the TLC model in pinouts/Host.h:
+    whatever Tlc.set(), Tlc.setAll(), Tlc.setRange() and Tlc.setAllDC() put
+    in #tlc_GSData (or the dot correction) has to be what the TLCs latch
+    after an update, with the right number of bytes or SCLK pulses on the
+    wire.  Build it with tlc5940_benchmark.sh, which runs it for every
+    transfer mode and with TLC_ASYNC_UPDATE, TLC_DOUBLE_BUFFER,
+    TLC_DIRTY_TRACKING and TLC_PWM_TICKS. */
+
+#include "Tlc5940.h"
+#include "tlc_test.h"
+
+/** What every channel should hold */
+static uint16_t expected[NUM_TLCS * 16];
+
+/** \returns 1 if #tlc_GSData holds expected[] */
+static uint8_t holdsExpected(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        if (Tlc.get(channel) != expected[channel]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** Shows #tlc_GSData and checks that the TLCs latch it.
+    \param firstGSInput 1 for the first update after dot correction, which
+           doesn't send the extra SCLK pulse */
+static void showAndCheck(uint8_t firstGSInput = 0)
+{
+    TLC_CHECK(!tlc_needXLAT);
+    tlc_host_resetStats();
+#if TLC_DOUBLE_BUFFER
+    Tlc.commit();
+#else
+    TLC_CHECK(Tlc.update() == 0);
+#endif
+    tlc_host_runSPI();
+    TlcHostStats stats = tlc_host().stats;
+#if DATA_TRANSFER_MODE == TLC_SPI || DATA_TRANSFER_MODE == TLC_USART_SPI
+    TLC_CHECK(stats.spiBytes == NUM_TLCS * 24);
+    TLC_CHECK(stats.sclkPulses == NUM_TLCS * 192);
+#else
+    TLC_CHECK(stats.sclkPulses == TLC_CHAIN_TLCS * 192 + !firstGSInput);
+#endif
+    TLC_CHECK(stats.spiCollisions == 0);
+    TLC_CHECK(stats.xlatPulses == 0); // nothing latches before the period ends
+    tlc_test_latch();
+    TLC_CHECK(!tlc_needXLAT);
+    if (!firstGSInput) {
+        TLC_CHECK(tlc_test_showing());
+    }
+}
+
+static void testInit(void)
+{
+    Tlc.init(1234);
+    tlc_host_pwmPeriod();
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        expected[channel] = 1234;
+        TLC_CHECK(tlc_host_getGS(channel) == 1234);
+    }
+    TLC_CHECK(holdsExpected());
+    TLC_CHECK(!tlc_needXLAT);
+#if TLC_DIRTY_TRACKING
+    TLC_CHECK(tlc_skippedUpdates == 0);
+#endif
+}
+
+static void testSet(void)
+{
+    for (uint8_t round = 0; round < 8; round++) {
+        for (uint16_t i = 0; i < NUM_TLCS * 8; i++) {
+            uint16_t channel = tlc_test_random() % (NUM_TLCS * 16);
+            uint16_t value = tlc_test_random() & 4095;
+            Tlc.set(channel, value);
+            expected[channel] = value;
+        }
+        TLC_CHECK(holdsExpected());
+        showAndCheck();
+    }
+}
+
+static void testSetAll(void)
+{
+    for (uint8_t round = 0; round < 4; round++) {
+        uint16_t value = round == 0 ? 4095 : tlc_test_random() & 4095;
+        Tlc.setAll(value);
+        for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+            expected[channel] = value;
+        }
+        TLC_CHECK(holdsExpected());
+        showAndCheck();
+    }
+}
+
+static void testSetRange(void)
+{
+    static uint16_t values[NUM_TLCS * 16];
+    for (uint8_t round = 0; round < 16; round++) {
+        uint16_t first = tlc_test_random() % (NUM_TLCS * 16);
+        uint16_t count = 1 + tlc_test_random() % (NUM_TLCS * 16 - first);
+        if (round == 0) { // every channel
+            first = 0;
+            count = NUM_TLCS * 16;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            values[i] = tlc_test_random() & 4095;
+            expected[first + i] = values[i];
+        }
+        Tlc.setRange(first, values, count);
+        TLC_CHECK(holdsExpected());
+        showAndCheck();
+    }
+}
+
+#if VPRG_ENABLED
+
+static void testSetAllDC(void)
+{
+    for (uint8_t round = 0; round < 3; round++) {
+        uint8_t value = round == 0 ? 63 : tlc_test_random() & 63;
+        tlc_host_resetStats();
+        Tlc.setAllDC(value);
+        TlcHostStats stats = tlc_host().stats;
+#if DATA_TRANSFER_MODE == TLC_SPI || DATA_TRANSFER_MODE == TLC_USART_SPI
+        TLC_CHECK(stats.spiBytes == NUM_TLCS * 12);
+#else
+        TLC_CHECK(stats.sclkPulses == TLC_CHAIN_TLCS * 96);
+#endif
+        TLC_CHECK(stats.xlatPulses == 1);
+        for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+            TLC_CHECK(tlc_host_getDC(channel) == value);
+        }
+        // the first grayscale input after dot correction only shows after
+        // the next one starts
+        Tlc.set(0, 100);
+        expected[0] = 100;
+        showAndCheck(1);
+        Tlc.set(0, 200);
+        expected[0] = 200;
+        showAndCheck();
+    }
+}
+
+#endif
+
+/** An update while the last one waits for its XLAT */
+static void testBusy(void)
+{
+    Tlc.set(1, 1000);
+    expected[1] = 1000;
+#if TLC_DOUBLE_BUFFER
+    Tlc.commit();
+    Tlc.set(1, 2000); // replaces the frame that's waiting
+    expected[1] = 2000;
+    Tlc.commit();
+    tlc_test_latch();
+    TLC_CHECK(tlc_test_showing());
+#else
+    TLC_CHECK(Tlc.update() == 0);
+    tlc_waitForTransfer();
+    Tlc.set(1, 2000);
+    TLC_CHECK(Tlc.update() == 1);
+    tlc_test_latch();
+    TLC_CHECK(tlc_host_getGS(1) == 1000);
+    expected[1] = 2000;
+    showAndCheck();
+#endif
+}
+
+#if TLC_ASYNC_UPDATE && TLC_DOUBLE_BUFFER
+
+/** A commit while the SPI interrupt is shifting out the last one, with
+    interrupts off: Tlc.commit() shifts out the rest itself instead of
+    waiting for the interrupt. */
+static void testCommitInterruptsOff(void)
+{
+    tlc_host_resetStats();
+    cli();
+    Tlc.set(5, Tlc.get(5) ^ 1);
+    Tlc.commit();
+    TLC_CHECK(SPCR & _BV(SPIE));
+    Tlc.set(6, Tlc.get(6) ^ 1);
+    expected[5] ^= 1;
+    expected[6] ^= 1;
+    Tlc.commit();
+    TLC_CHECK(!(SPCR & _BV(SPIE)));
+    sei();
+    tlc_test_latch();
+    TLC_CHECK(tlc_host().stats.spiBytes == 2 * NUM_TLCS * 24);
+    TLC_CHECK(tlc_host().stats.spiCollisions == 0);
+    TLC_CHECK(tlc_test_showing());
+    TLC_CHECK(holdsExpected());
+}
+
+#endif
+
+static uint8_t slowCalls;
+static uint8_t slowDepth;
+static uint8_t slowMaxDepth;
+
+/** A tlc_onUpdateFinished that starts an update and then takes two PWM
+    periods, so the update latches while it's still running. */
+static void slowCallback(void)
+{
+    slowCalls++;
+    if (++slowDepth > slowMaxDepth) {
+        slowMaxDepth = slowDepth;
+    }
+    if (slowCalls < 5) {
+        Tlc.set(4, slowCalls);
+        expected[4] = slowCalls;
+        tlc_present();
+        tlc_host_pwmPeriod();
+        tlc_host_pwmPeriod();
+    } else {
+        tlc_onUpdateFinished = 0;
+    }
+    if (!tlc_needXLAT) {
+        set_XLAT_interrupt();
+    }
+    slowDepth--;
+}
+
+/** The XLAT interrupt doesn't re-enter a callback that overruns a PWM
+    period, it calls it again a period after it returns. */
+static void testSlowCallback(void)
+{
+    tlc_onUpdateFinished = (volatile void (*)(void))slowCallback;
+    set_XLAT_interrupt();
+    for (uint8_t period = 0; period < 10 && tlc_onUpdateFinished; period++) {
+        tlc_host_pwmPeriod();
+    }
+    TLC_CHECK(!tlc_onUpdateFinished);
+    TLC_CHECK(slowCalls == 5);
+    TLC_CHECK(slowMaxDepth == 1);
+    tlc_test_latch();
+    TLC_CHECK(tlc_test_showing());
+}
+
+#if TLC_DIRTY_TRACKING
+
+static void testDirtyTracking(void)
+{
+    uint32_t skipped = tlc_skippedUpdates;
+    tlc_host_resetStats();
+    Tlc.set(2, Tlc.get(2)); // no change
+    tlc_present();
+    tlc_host_runSPI();
+    TLC_CHECK(tlc_skippedUpdates == skipped + 1);
+    TLC_CHECK(tlc_host().stats.sclkPulses == 0);
+    TLC_CHECK(!tlc_needXLAT);
+    Tlc.set(2, Tlc.get(2) ^ 1);
+    expected[2] ^= 1;
+    showAndCheck();
+
+    // a range that's already there isn't shifted out either
+    uint16_t values[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        values[i] = Tlc.get(i);
+    }
+    skipped = tlc_skippedUpdates;
+    tlc_host_resetStats();
+    Tlc.setRange(0, values, 6);
+    tlc_present();
+    tlc_host_runSPI();
+    TLC_CHECK(tlc_skippedUpdates == skipped + 1);
+    TLC_CHECK(tlc_host().stats.sclkPulses == 0);
+    values[4] ^= 1;
+    Tlc.setRange(0, values, 6);
+    expected[4] = values[4];
+    showAndCheck();
+}
+
+#endif
+
+#if TLC_PWM_TICKS
+
+/** A period that ends with interrupts off leaves its overflow pending.  An
+    update armed before the interrupt runs hasn't been latched by it, the
+    overflow is only a tick. */
+static void testPendingOverflow(void)
+{
+    uint32_t ticks = tlc_getPwmTicks();
+    Tlc.set(3, Tlc.get(3) ^ 1);
+    expected[3] ^= 1;
+    cli();
+    tlc_host_pwmPeriod();
+    tlc_present();
+    sei();
+    tlc_host_runSPI();
+    TLC_CHECK(tlc_needXLAT);
+    TLC_CHECK(tlc_getPwmTicks() == ticks + 1);
+    tlc_test_latch();
+    TLC_CHECK(!tlc_needXLAT);
+    TLC_CHECK(tlc_test_showing());
+}
+
+#endif
+
+int main(void)
+{
+    testInit();
+    testSet();
+    testSetAll();
+    testSetRange();
+#if VPRG_ENABLED
+    testSetAllDC();
+#endif
+    testBusy();
+    testSlowCallback();
+#if TLC_ASYNC_UPDATE && TLC_DOUBLE_BUFFER
+    testCommitInterruptsOff();
+#endif
+#if TLC_PWM_TICKS
+    testPendingOverflow();
+#endif
+#if TLC_DIRTY_TRACKING
+    testDirtyTracking();
+#endif
+    return tlc_test_done();
+}
+
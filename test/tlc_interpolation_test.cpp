@@ -0,0 +1,126 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_interpolation.h: random keyframes played with
+    tlc_playInterpolatedAnimation() have to blend every PWM period to within
+    a step of the exact line (or curve) between them, show each keyframe
+    exactly and end after the last one. */
+
+#include <string.h>
+#include "Tlc5940.h"
+#include "tlc_interpolation.h"
+#include "tlc_test.h"
+
+/** The keyframes in the test animation */
+#define TEST_KEYFRAMES    5
+
+/** Each keyframe's channels, in playing order */
+static uint16_t keys[TEST_KEYFRAMES][NUM_TLCS * 16];
+/** The keyframes last first, for tlc_playInterpolatedAnimation() */
+static uint8_t animation[TEST_KEYFRAMES * NUM_TLCS * 24];
+
+static void makeKeyframes(void)
+{
+    for (uint8_t key = 0; key < TEST_KEYFRAMES; key++) {
+        uint8_t *frame = animation
+                         + (TEST_KEYFRAMES - 1 - key) * NUM_TLCS * 24;
+        for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+            keys[key][channel] = channel == 0? key * 1023 // a full swing
+                                             : tlc_test_random() & 4095;
+            tlc_setPacked(frame, NUM_TLCS * 16 - 1 - channel,
+                          keys[key][channel]);
+        }
+    }
+}
+
+/** Plays the keyframes and checks every period.
+    \param periods PWM periods from one keyframe to the next
+    \param tolerance how far a blended channel can be from the exact one */
+static void checkInterpolation(uint16_t periods, uint8_t curve,
+                               int16_t tolerance)
+{
+    tlc_playInterpolatedAnimation(animation, TEST_KEYFRAMES, periods, curve);
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        TLC_CHECK(Tlc.get(channel) == keys[0][channel]);
+    }
+    for (uint8_t key = 1; key < TEST_KEYFRAMES; key++) {
+        for (uint16_t period = 1; period <= periods; period++) {
+            tlc_host_pwmPeriod();
+            // the exact blend, as a fraction of 4096
+            uint32_t t = tlc_curve(curve, (uint32_t)period * 4096 / periods);
+            for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+                int32_t from = keys[key - 1][channel];
+                int32_t to = keys[key][channel];
+                int32_t got = Tlc.get(channel);
+                if (period == periods) {
+                    TLC_CHECK(got == to);
+                } else {
+                    int32_t diff = got - (from + (to - from) * (int32_t)t
+                                                 / 4096);
+                    TLC_CHECK(diff >= -tolerance && diff <= tolerance);
+                }
+            }
+        }
+    }
+    TLC_CHECK(tlc_onUpdateFinished);
+    tlc_test_latch();
+    TLC_CHECK(!tlc_onUpdateFinished);
+    TLC_CHECK(tlc_test_showing());
+}
+
+/** Two keyframes that are the same: with #TLC_DIRTY_TRACKING the blends
+    between them aren't shifted out, and the animation still ends on time */
+static void checkHold(uint16_t periods)
+{
+    static uint8_t hold[2 * NUM_TLCS * 24];
+    memcpy(hold, animation + (TEST_KEYFRAMES - 1) * NUM_TLCS * 24,
+           NUM_TLCS * 24);
+    memcpy(hold + NUM_TLCS * 24, hold, NUM_TLCS * 24);
+#if TLC_DIRTY_TRACKING
+    uint32_t skipped = tlc_skippedUpdates;
+#endif
+    tlc_playInterpolatedAnimation(hold, 2, periods, TLC_CURVE_LINEAR);
+    for (uint16_t period = 0; period < periods; period++) {
+        TLC_CHECK(tlc_onUpdateFinished);
+        tlc_host_pwmPeriod();
+    }
+    tlc_test_latch();
+    TLC_CHECK(!tlc_onUpdateFinished);
+#if TLC_DIRTY_TRACKING
+    TLC_CHECK(tlc_skippedUpdates >= skipped + periods - 1);
+#endif
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        TLC_CHECK(Tlc.get(channel) == keys[0][channel]);
+    }
+    TLC_CHECK(tlc_test_showing());
+}
+
+int main(void)
+{
+    makeKeyframes();
+    Tlc.init();
+    tlc_host_pwmPeriod();
+    checkInterpolation(1, TLC_CURVE_LINEAR, 0);
+    checkInterpolation(7, TLC_CURVE_LINEAR, 1);
+    checkInterpolation(100, TLC_CURVE_LINEAR, 1);
+    checkInterpolation(7, TLC_CURVE_EASE_IN_OUT, 3);
+    checkInterpolation(100, TLC_CURVE_EASE_IN_OUT, 3);
+    checkHold(10);
+    return tlc_test_done();
+}
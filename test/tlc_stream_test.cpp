@@ -0,0 +1,192 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_stream.h: frames streamed from a file (read in full or
+    a few bytes at a time, with stalls) and from a ring buffer have to show
+    up on the TLCs in order, none lost, with underruns counted only when
+    the source falls behind. */
+
+#include "Tlc5940.h"
+#include "tlc_stream.h"
+#include "tlc_test.h"
+
+/** The frames in the test stream */
+#define TEST_FRAMES         40
+/** Bytes in a frame */
+#define TEST_FRAME_BYTES    (NUM_TLCS * 24)
+
+static uint8_t frames[TEST_FRAMES][TEST_FRAME_BYTES];
+static FILE *file;
+/** Bytes per read of the file, 0 for as many as asked for */
+static uint16_t readLimit;
+static uint16_t readCalls;
+/** The next frame that should show up */
+static uint16_t nextFrame;
+
+/** The value of a channel in a frame.  Channel 0 is the frame number + 1, so
+    every frame is different from the one before it. */
+static uint16_t frameValue(uint16_t frame, uint16_t channel)
+{
+    if (channel == 0) {
+        return frame + 1;
+    }
+    return (frame * 37 + channel * 101 + frame * channel) & 4095;
+}
+
+static void makeFrames(void)
+{
+    for (uint16_t frame = 0; frame < TEST_FRAMES; frame++) {
+        for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+            tlc_setPacked(frames[frame], NUM_TLCS * 16 - 1 - channel,
+                          frameValue(frame, channel));
+        }
+    }
+}
+
+/** A Tlc_StreamSource read of the file.  With a readLimit, two of every
+    three calls find nothing there yet, like a slow serial port. */
+static int16_t readFile(uint8_t *buffer, uint16_t count)
+{
+    if (readLimit) {
+        if (++readCalls % 3) {
+            return 0;
+        }
+        if (count > readLimit) {
+            count = readLimit;
+        }
+    }
+    size_t read = fread(buffer, 1, count, file);
+    if (!read) {
+        return feof(file)? -1 : 0;
+    }
+    return (int16_t)read;
+}
+
+/** Checks for a new frame on the TLCs: it has to be the next one, whole. */
+static void checkShowing(void)
+{
+    uint16_t shown = tlc_host_getGS(0);
+    if (shown == nextFrame) { // the last frame (or 0 before the first)
+        return;
+    }
+    TLC_CHECK(shown == nextFrame + 1);
+    if (shown != nextFrame + 1) {
+        nextFrame = shown;
+        return;
+    }
+    for (uint16_t channel = 1; channel < NUM_TLCS * 16; channel++) {
+        TLC_CHECK(tlc_host_getGS(channel) == frameValue(nextFrame, channel));
+    }
+    nextFrame++;
+}
+
+/** Turns every channel off before the next stream */
+static void clearShown(void)
+{
+    Tlc.clear();
+    tlc_present();
+    tlc_test_latch();
+}
+
+/** Runs PWM periods until the stream is done, filling the FIFO every
+    period.  Before every fill write, if there is one, adds bytes to the
+    source. */
+static void play(void (*write)(void))
+{
+    uint32_t periods = 0;
+    nextFrame = 0;
+    checkShowing();
+    while (tlc_onUpdateFinished && periods < 100000UL) {
+        if (write) {
+            write();
+        }
+        tlc_streamFill();
+        tlc_host_pwmPeriod();
+        periods++;
+        checkShowing();
+    }
+    TLC_CHECK(!tlc_onUpdateFinished);
+    tlc_test_latch();
+    checkShowing();
+    TLC_CHECK(nextFrame == TEST_FRAMES);
+}
+
+static void testFile(void)
+{
+    file = tmpfile();
+    TLC_CHECK(file != 0);
+    if (!file) {
+        return;
+    }
+    fwrite(frames, TEST_FRAME_BYTES, TEST_FRAMES, file);
+    for (uint8_t slow = 0; slow < 2; slow++) {
+        rewind(file);
+        readLimit = slow? 5 : 0;
+        readCalls = 0;
+        struct Tlc_StreamSource source;
+        tlc_initStreamSource(&source, readFile);
+        clearShown();
+        tlc_playStream(&source.source, 2);
+        play(0);
+        if (slow) { // a frame takes more periods to read than to show
+            TLC_CHECK(tlc_streamUnderruns > 0);
+        } else {
+            TLC_CHECK(tlc_streamUnderruns == 0);
+        }
+    }
+    fclose(file);
+}
+
+static struct Tlc_RingSource ring;
+static uint8_t ringBuffer[1024];
+static uint16_t written;
+
+/** Writes the frames into the ring 7 bytes at a time, then ends it */
+static void writeRing(void)
+{
+    if (written < TEST_FRAMES * TEST_FRAME_BYTES) {
+        uint16_t count = TEST_FRAMES * TEST_FRAME_BYTES - written;
+        written += tlc_ringWrite(&ring, &frames[0][0] + written,
+                                 count < 7? count : 7);
+    } else {
+        tlc_ringEnd(&ring);
+    }
+}
+
+static void testRing(void)
+{
+    tlc_initRingSource(&ring, ringBuffer, sizeof(ringBuffer));
+    written = 0;
+    clearShown();
+    tlc_playStream(&ring.source, 0);
+    play(writeRing);
+    TLC_CHECK(written == TEST_FRAMES * TEST_FRAME_BYTES);
+}
+
+int main(void)
+{
+    makeFrames();
+    Tlc.init();
+    tlc_host_pwmPeriod();
+    testFile();
+#if NUM_TLCS * 24 <= 1024
+    testRing();
+#endif
+    return tlc_test_done();
+}
@@ -0,0 +1,103 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+#ifndef TLC_TEST_H
+#define TLC_TEST_H
+
+/** \file
+    Shared code for the host tests (see tlc5940_benchmark.sh).  Include this
+    after the library headers: it needs tlc_host() from pinouts/Host.h.
+
+    A test is a main() that runs TLC_CHECK()s against the TLC model and
+    returns tlc_test_done().  Failed checks are printed, passing ones are
+    only counted. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint32_t tlc_test_checks;
+static uint32_t tlc_test_failures;
+
+/** Counts a check and prints it if it failed.  Stops the test after 20
+    failures, the rest would only repeat them. */
+#define TLC_CHECK(condition) \
+    do { \
+        tlc_test_checks++; \
+        if (!(condition)) { \
+            tlc_test_fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+static inline void tlc_test_fail(const char *file, int line,
+                                 const char *condition)
+{
+    printf("%s:%d: FAILED (NUM_TLCS=%u): %s\n", file, line,
+           (unsigned)NUM_TLCS, condition);
+    if (++tlc_test_failures == 20) {
+        printf("too many failures, stopping\n");
+        exit(1);
+    }
+}
+
+/** Prints the totals.
+    \returns the exit code for main(): 0 if every check passed */
+static inline int tlc_test_done(void)
+{
+    if (tlc_test_failures) {
+        printf("%lu of %lu checks failed\n", (unsigned long)tlc_test_failures,
+               (unsigned long)tlc_test_checks);
+        return 1;
+    }
+    return 0;
+}
+
+/** A repeatable pseudo-random number (xorshift), the same on every host */
+static inline uint16_t tlc_test_random(void)
+{
+    static uint32_t state = 2463534242UL;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (uint16_t)(state >> 8);
+}
+
+/** Two PWM periods, enough to latch any update: with #TLC_DOUBLE_BUFFER a
+    pending frame is only shifted in by the first XLAT interrupt. */
+static inline void tlc_test_latch(void)
+{
+    tlc_host_pwmPeriod();
+    tlc_host_pwmPeriod();
+}
+
+/** \returns 1 if the TLCs are showing what Tlc.get() reads from
+             #tlc_GSData on every channel */
+static inline uint8_t tlc_test_showing(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        if (tlc_host_getGS(channel) != Tlc.get(channel)) {
+            printf("  channel %u: showing %u, tlc_GSData has %u\n",
+                   (unsigned)channel, (unsigned)tlc_host_getGS(channel),
+                   (unsigned)Tlc.get(channel));
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#endif
+
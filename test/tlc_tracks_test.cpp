@@ -0,0 +1,156 @@
+/*  Copyright (c) 2009 by Alex Leone <acleone ~AT~ gmail.com>
+
+    This file is part of the Arduino TLC5940 Library.
+
+    The Arduino TLC5940 Library is free software: you can redistribute it
+    and/or modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    The Arduino TLC5940 Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with The Arduino TLC5940 Library.  If not, see
+    <http://www.gnu.org/licenses/>. */
+
+/** \file
+    Host test of tlc_tracks.h: three tracks with random frames and channels,
+    different frame rates, each blend mode and looping or holding their
+    last frame, are merged by the XLAT interrupt every PWM period.  A model
+    of each track's frame and of the blend has to agree with #tlc_GSData on
+    every channel, also after a track is removed. */
+
+#include "Tlc5940.h"
+#include "tlc_tracks.h"
+#include "tlc_test.h"
+
+/** The tracks played */
+#define TEST_TRACKS    3
+/** Frames in each track's animation */
+#define TEST_FRAMES    6
+
+/** Each track's channels in each frame, in playing order */
+static uint16_t values[TEST_TRACKS][TEST_FRAMES][NUM_TLCS * 16];
+/** Each track's frames last first, like tlc_playAnimation() */
+static uint8_t animations[TEST_TRACKS][TEST_FRAMES * NUM_TLCS * 24];
+static uint8_t channels[TEST_TRACKS][NUM_TLCS * 2];
+static struct Tlc_Track tracks[TEST_TRACKS];
+
+/** The model: each track's frame (counting up) and the periods it has left */
+static uint16_t modelFrame[TEST_TRACKS];
+static uint16_t modelWait[TEST_TRACKS];
+static uint8_t modelPlaying[TEST_TRACKS];
+/** What each channel should hold */
+static uint16_t expected[NUM_TLCS * 16];
+
+static void makeTracks(void)
+{
+    static const uint16_t periods[TEST_TRACKS] = {0, 2, 5};
+    static const uint8_t blends[TEST_TRACKS] = {TLC_BLEND_REPLACE,
+                                                TLC_BLEND_ADD, TLC_BLEND_MAX};
+    for (uint8_t i = 0; i < TEST_TRACKS; i++) {
+        for (uint16_t frame = 0; frame < TEST_FRAMES; frame++) {
+            uint8_t *data = animations[i]
+                            + (TEST_FRAMES - 1 - frame) * NUM_TLCS * 24;
+            for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+                values[i][frame][channel] = tlc_test_random() & 4095;
+                tlc_setPacked(data, NUM_TLCS * 16 - 1 - channel,
+                              values[i][frame][channel]);
+            }
+        }
+        for (uint8_t b = 0; b < NUM_TLCS * 2; b++) {
+            channels[i][b] = tlc_test_random();
+        }
+        tracks[i].animation = tlc_animationAddress(animations[i]);
+        tracks[i].frames = TEST_FRAMES;
+        tracks[i].periodsPerFrame = periods[i];
+        tracks[i].channels = channels[i];
+        tracks[i].blend = blends[i];
+        tracks[i].loop = i != 1;
+    }
+}
+
+/** One PWM period of the model: every track waits or moves to its next
+    frame, then the playing tracks are blended on the channels they play
+    on. */
+static void modelPeriod(uint8_t first)
+{
+    for (uint8_t i = 0; i < TEST_TRACKS; i++) {
+        if (first || !modelPlaying[i]) {
+            continue; // the first period shows the first frames
+        }
+        if (modelWait[i]) {
+            modelWait[i]--;
+        } else if (modelFrame[i] < TEST_FRAMES - 1 || tracks[i].loop) {
+            modelFrame[i] = (modelFrame[i] + 1) % TEST_FRAMES;
+            modelWait[i] = tracks[i].periodsPerFrame;
+        }
+    }
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        uint8_t covered = 0;
+        for (uint8_t i = 0; i < TEST_TRACKS; i++) {
+            if (!modelPlaying[i]
+                    || !(channels[i][channel >> 3] & (1 << (channel & 7)))) {
+                continue;
+            }
+            uint16_t value = values[i][modelFrame[i]][channel];
+            if (covered && tracks[i].blend == TLC_BLEND_ADD) {
+                value += expected[channel];
+                if (value > 4095) {
+                    value = 4095;
+                }
+            } else if (covered && tracks[i].blend == TLC_BLEND_MAX
+                       && expected[channel] > value) {
+                value = expected[channel];
+            }
+            expected[channel] = value;
+            covered = 1;
+        }
+    }
+}
+
+static void checkExpected(void)
+{
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        TLC_CHECK(Tlc.get(channel) == expected[channel]);
+    }
+}
+
+int main(void)
+{
+    makeTracks();
+    Tlc.init(77);
+    tlc_host_pwmPeriod();
+    for (uint16_t channel = 0; channel < NUM_TLCS * 16; channel++) {
+        expected[channel] = 77; // until a track plays on it
+    }
+    for (uint8_t i = 0; i < TEST_TRACKS; i++) {
+        tlc_setTrack(i, tracks + i);
+        modelPlaying[i] = 1;
+        modelWait[i] = tracks[i].periodsPerFrame;
+    }
+    tlc_startTracks();
+    for (uint16_t period = 0; period < 80; period++) {
+        tlc_host_pwmPeriod();
+        modelPeriod(period == 0);
+        checkExpected();
+    }
+
+    // channels only the removed track played on keep their values
+    tlc_setTrack(1, 0);
+    modelPlaying[1] = 0;
+    for (uint16_t period = 0; period < 20; period++) {
+        tlc_host_pwmPeriod();
+        modelPeriod(0);
+        checkExpected();
+    }
+
+    tlc_stopTracks();
+    tlc_test_latch();
+    TLC_CHECK(tlc_test_showing());
+    checkExpected();
+    return tlc_test_done();
+}
@@ -0,0 +1,60 @@
+#!/bin/sh
+# Run this script to check the AVR assembly in the library with avr-gcc.
+# The host build (tlc5940_benchmark.sh) never compiles it: the ELPM loops in
+# tlc_progmem_utils.h (TLC_FAR_PROGMEM) are only built for a chip with RAMPZ.
+#
+#   ./tlc5940_avr_check.sh
+#
+# test/avr/tlc_far_progmem_check.cpp is built with the library for the
+# ATmega2560 (AVR_MCU) and checked for the ELPM Z+ loops and for an array
+# that crosses 64 KB of flash.  If simavr is installed it's run too, and has
+# to print "tlc_far_progmem_check: ok".  Without avr-gcc the script says so
+# and exits with 0, without simavr only the build is checked.  A failed check
+# prints what failed and the script exits with 1.
+
+AVR_CXX=${AVR_CXX:-avr-g++}
+AVR_OBJDUMP=${AVR_OBJDUMP:-avr-objdump}
+AVR_NM=${AVR_NM:-avr-nm}
+AVR_MCU=${AVR_MCU:-atmega2560}
+SIMAVR=${SIMAVR:-simavr}
+
+ROOT=$(cd "$(dirname "$0")" && pwd)
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+if ! command -v "$AVR_CXX" > /dev/null 2>&1; then
+    echo "$AVR_CXX not found, nothing checked"
+    exit 0
+fi
+
+ELF="$BUILD/tlc_far_progmem_check.elf"
+$AVR_CXX -mmcu="$AVR_MCU" -DF_CPU=16000000UL -Os -Wall \
+    -fdata-sections -fno-toplevel-reorder \
+    -D__PROG_TYPES_COMPAT__ -DTLC_FAR_PROGMEM=1 -I"$ROOT/Tlc5940" \
+    -o "$ELF" "$ROOT/test/avr/tlc_far_progmem_check.cpp" \
+    "$ROOT/Tlc5940/Tlc5940.cpp" || exit 2
+
+# 3 in tlc_setGSfromFarProgmem() and 1 in tlc_copyFromFarProgmem()
+elpms=$($AVR_OBJDUMP -d "$ELF" | grep -c 'elpm[[:space:]]*r0, Z+')
+if [ "$elpms" -lt 4 ]; then
+    echo "expected the ELPM Z+ loops, found $elpms elpm r0, Z+" >&2
+    exit 1
+fi
+
+farData=$($AVR_NM "$ELF" | awk '$3 == "farData" { print $1 }')
+if [ -z "$farData" ]; then
+    echo "farData not found" >&2
+    exit 1
+fi
+echo "farData at 0x$farData, $elpms elpm r0, Z+"
+
+if ! command -v "$SIMAVR" > /dev/null 2>&1; then
+    echo "$SIMAVR not found, only the build was checked"
+    exit 0
+fi
+output=$(timeout 60 "$SIMAVR" -m "$AVR_MCU" -f 16000000 "$ELF" 2>&1)
+echo "$output"
+if ! echo "$output" | grep -q 'tlc_far_progmem_check: ok'; then
+    echo "tlc_far_progmem_check failed" >&2
+    exit 1
+fi
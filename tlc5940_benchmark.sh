@@ -0,0 +1,175 @@
+#!/bin/sh
+# Run this script to benchmark the library hot paths on a workstation.
+# The library is built with -DTLC_HOST (see Tlc5940/pinouts/Host.h) for every
+# NUM_TLCS in TLC_BENCH_SIZES and every transfer mode in TLC_BENCH_MODES
+# (TLC_PARALLEL_BITBANG uses TLC_BENCH_CHAINS chains, sizes that don't split
+# evenly are skipped).  The fade rows are built again with
+# TLC_FADE_COMPACT=1, those rows end in _compact.
+#
+#   ./tlc5940_benchmark.sh > before.txt
+#   (make changes)
+#   ./tlc5940_benchmark.sh before.txt
+#
+# Before the benchmarks every test in test/ is built and run for the same
+# NUM_TLCS and mode (with VPRG_ENABLED), and again with each set of options
+# in TLC_TEST_OPTIONS (OPTION or OPTION=value, separated by commas) for the
+# sizes in TLC_TEST_SIZES.  A failed test prints what failed and the script
+# exits with 1.
+#
+# With a previous table, rows where io_ops, spi_bytes, sclk or est_cycles went
+# up are marked REGRESSION and the script exits with 1.  Those columns come
+# from the register mock, so they are the same on every machine.  est_cycles
+# only counts i/o, SPI waits and interrupts, so the ram and arithmetic work
+# is only in host_ns: rows where host_ns went up more than
+# TLC_BENCH_NS_TOLERANCE percent (and more than TLC_BENCH_NS_FLOOR ns) are
+# marked SLOWER and fail too.  host_ns is scaled by ref_ns, a fixed loop
+# timed alongside it, so the machine getting faster or slower as a whole
+# doesn't count, but make both tables on the same, otherwise idle machine
+# anyway; host timing is noisy.
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+TLC_BENCH_SIZES=${TLC_BENCH_SIZES:-"1 2 4 8 16 32"}
+TLC_BENCH_MODES=${TLC_BENCH_MODES:-"TLC_SPI TLC_USART_SPI TLC_BITBANG TLC_PARALLEL_BITBANG"}
+TLC_BENCH_CHAINS=${TLC_BENCH_CHAINS:-4}
+TLC_BENCH_NS_TOLERANCE=${TLC_BENCH_NS_TOLERANCE:-50}
+TLC_BENCH_NS_FLOOR=${TLC_BENCH_NS_FLOOR:-20}
+TLC_TEST_SIZES=${TLC_TEST_SIZES:-"4 32"}
+TLC_TEST_OPTIONS=${TLC_TEST_OPTIONS:-"TLC_DIRTY_TRACKING TLC_DOUBLE_BUFFER TLC_ASYNC_UPDATE,TLC_PWM_TICKS TLC_DOUBLE_BUFFER,TLC_DIRTY_TRACKING,TLC_ASYNC_UPDATE,TLC_PWM_TICKS TLC_FADE_COMPACT"}
+
+ROOT=$(cd "$(dirname "$0")" && pwd)
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+RESULTS="$BUILD/results.txt"
+
+# builds the library and every test with the defines in $1 and runs them
+run_tests() {
+    $CXX $CXXFLAGS $1 -DVPRG_ENABLED=1 -I"$ROOT/Tlc5940" -c \
+        -o "$BUILD/Tlc5940.o" "$ROOT/Tlc5940/Tlc5940.cpp" || exit 2
+    for test in "$ROOT"/test/*.cpp; do
+        name=$(basename "$test" .cpp)
+        $CXX $CXXFLAGS $1 -DVPRG_ENABLED=1 -I"$ROOT/Tlc5940" -I"$ROOT/test" \
+            -o "$BUILD/$name" "$test" "$BUILD/Tlc5940.o" || exit 2
+        if ! "$BUILD/$name" >&2; then
+            echo "$name failed:$1" >&2
+            exit 1
+        fi
+    done
+}
+
+first=1
+for mode in $TLC_BENCH_MODES; do
+    for tlcs in $TLC_BENCH_SIZES; do
+        defines="-DTLC_HOST -DNUM_TLCS=$tlcs -DDATA_TRANSFER_MODE=$mode"
+        if [ "$tlcs" -gt 16 ]; then
+            defines="$defines -DTLC_CHANNEL_TYPE=uint16_t"
+        fi
+        mux=1
+        if [ "$mode" = TLC_PARALLEL_BITBANG ]; then
+            if [ $((tlcs % TLC_BENCH_CHAINS)) -ne 0 ]; then
+                continue
+            fi
+            defines="$defines -DTLC_NUM_CHAINS=$TLC_BENCH_CHAINS"
+            mux=0 # Tlc5940Mux doesn't have this mode
+        fi
+        if [ "$mode" = TLC_USART_SPI ]; then
+            mux=0
+        fi
+        run_tests "$defines"
+        for size in $TLC_TEST_SIZES; do
+            if [ "$size" -ne "$tlcs" ]; then
+                continue
+            fi
+            for options in $TLC_TEST_OPTIONS; do
+                optionDefines=
+                for option in $(echo "$options" | tr , ' '); do
+                    if [ "$option" = TLC_ASYNC_UPDATE ] \
+                            && [ "$mode" != TLC_SPI ]; then
+                        continue
+                    fi
+                    case "$option" in
+                        *=*) optionDefines="$optionDefines -D$option" ;;
+                        *) optionDefines="$optionDefines -D$option=1" ;;
+                    esac
+                done
+                run_tests "$defines$optionDefines"
+            done
+        done
+        $CXX $CXXFLAGS $defines -I"$ROOT/Tlc5940" -I"$ROOT/benchmark" \
+            -o "$BUILD/tlc_benchmark" "$ROOT/benchmark/tlc_benchmark.cpp" \
+            "$ROOT/Tlc5940/Tlc5940.cpp" || exit 2
+        $CXX $CXXFLAGS $defines -DTLC_FADE_COMPACT=1 -I"$ROOT/Tlc5940" \
+            -I"$ROOT/benchmark" -o "$BUILD/tlc_benchmark_compact" \
+            "$ROOT/benchmark/tlc_benchmark.cpp" "$ROOT/Tlc5940/Tlc5940.cpp" \
+            || exit 2
+        if [ $mux -eq 1 ]; then
+            $CXX $CXXFLAGS $defines -I"$ROOT/Tlc5940Mux" -I"$ROOT/benchmark" \
+                -o "$BUILD/tlcmux_benchmark" \
+                "$ROOT/benchmark/tlcmux_benchmark.cpp" || exit 2
+        fi
+        if [ $first -eq 1 ]; then
+            "$BUILD/tlc_benchmark" >> "$RESULTS" || exit 2
+            first=0
+        else
+            "$BUILD/tlc_benchmark" | grep -v '^#' >> "$RESULTS" || exit 2
+        fi
+        "$BUILD/tlc_benchmark_compact" >> "$RESULTS" || exit 2
+        if [ $mux -eq 1 ]; then
+            "$BUILD/tlcmux_benchmark" >> "$RESULTS" || exit 2
+        fi
+    done
+done
+
+if [ -z "$1" ]; then
+    cat "$RESULTS"
+    exit 0
+fi
+
+# compare against the previous table
+awk -v tolerance="$TLC_BENCH_NS_TOLERANCE" -v floor="$TLC_BENCH_NS_FLOOR" '
+    FNR == NR {
+        if ($1 !~ /^#/) {
+            old[$1 " " $2 " " $3] = $0;
+        }
+        next;
+    }
+    /^#/ {
+        printf "%s %9s %8s  %s\n", $0, "cycles%", "ns%", "status";
+        next;
+    }
+    {
+        key = $1 " " $2 " " $3;
+        if (!(key in old)) {
+            printf "%s %9s %8s  %s\n", $0, "-", "-", "new";
+            next;
+        }
+        split(old[key], o);
+        status = "ok";
+        for (i = 4; i <= 7; i++) {
+            if ($i > o[i]) {
+                status = "REGRESSION";
+            }
+        }
+        # the old host_ns, as if the machine was as fast as it is now
+        before = o[8] * $9 / o[9];
+        if (status == "ok" && $8 > before * (1 + tolerance / 100) &&
+                $8 > before + floor) {
+            status = "SLOWER";
+        }
+        if (status != "ok") {
+            failed = 1;
+        }
+        printf "%s %9s %8s  %s\n", $0, pct($7, o[7]), pct($8, before),
+               status;
+    }
+    function pct(now, before) {
+        if (now == before) {
+            return "0.0";
+        }
+        if (before == 0) {
+            return "-";
+        }
+        return sprintf("%+.1f", (now - before) * 100 / before);
+    }
+    END { exit failed; }
+' "$1" "$RESULTS"